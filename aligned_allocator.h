@@ -0,0 +1,75 @@
+/*
+ * aligned_allocator<T, Align, Pad> - allocator returning storage aligned to 'Align' bytes.
+ *
+ * With Pad = true it also declares a capacity_granularity of one 'Align'-byte block, so vector
+ * rounds every capacity up to whole blocks: a SIMD kernel of width Align can then load full,
+ * aligned registers up to round_up(size(), block) without a scalar tail loop. The elements
+ * past size() are uninitialized storage, so such kernels must ignore the extra lanes.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include "vector.h"
+
+template <typename T, std::size_t Align = 64, bool Pad = false>
+class aligned_allocator {
+    static_assert(std::has_single_bit(Align), "alignment must be a power of two");
+    static_assert(Align >= alignof(T), "alignment must be at least alignof(T)");
+
+public:
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using is_always_equal = std::true_type;
+
+    static constexpr std::size_t alignment = Align;
+
+    // capacities are multiples of the number of elements in one aligned block (see vector::round_capacity)
+    static constexpr std::size_t capacity_granularity = Pad ? (Align + sizeof(T) - 1) / sizeof(T) : 1;
+
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Align, Pad>;
+    };
+
+    constexpr aligned_allocator() noexcept = default;
+
+    template <typename U>
+    constexpr aligned_allocator(const aligned_allocator<U, Align, Pad>&) noexcept {}
+
+    [[nodiscard]] constexpr T* allocate(std::size_t n) {
+        if (std::is_constant_evaluated()) {
+            return std::allocator<T>().allocate(n);
+        }
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+            VECTOR_THROW(std::bad_array_new_length());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    constexpr void deallocate(T* p, std::size_t n) noexcept {
+        if (std::is_constant_evaluated()) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        ::operator delete(p, n * sizeof(T), std::align_val_t(Align));
+    }
+
+    template <typename U>
+    constexpr bool operator==(const aligned_allocator<U, Align, Pad>&) const noexcept { return true; }
+
+    template <typename U>
+    constexpr bool operator!=(const aligned_allocator<U, Align, Pad>&) const noexcept { return false; }
+};
+
+// A vector whose data() is aligned to 'Align' bytes and whose capacity is padded to whole 'Align'-byte blocks
+template <typename T, std::size_t Align = 64>
+using aligned_vector = vector<T, aligned_allocator<T, Align, true>>;
@@ -0,0 +1,290 @@
+/*
+ * Benchmark harness with Linux hardware performance counters.
+ *
+ * Every benchmark is wrapped with perf_event_open counters (cycles, instructions,
+ * L1d / LLC misses, dTLB misses, branch misses) plus page faults and wall-clock time.
+ * Counters that the kernel, the CPU or the sandbox refuse to open are reported as "n/a";
+ * on non-Linux systems only wall-clock time and (where available) rusage faults are kept.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_HARNESS_HAS_PERF_EVENT 1
+#else
+#define PERF_HARNESS_HAS_PERF_EVENT 0
+#endif
+
+namespace bench {
+
+// Prevents the compiler from optimizing away a computed value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Forces all pending memory writes to be considered observable
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+enum class counter : std::size_t {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    dtlb_misses,
+    branch_misses,
+    page_faults,
+    count_
+};
+
+inline constexpr std::size_t counter_count = static_cast<std::size_t>(counter::count_);
+
+inline const char* counter_name(counter c) {
+    switch (c) {
+    case counter::cycles:        return "cycles";
+    case counter::instructions:  return "instr";
+    case counter::l1d_misses:    return "L1d-miss";
+    case counter::llc_misses:    return "LLC-miss";
+    case counter::dtlb_misses:   return "dTLB-miss";
+    case counter::branch_misses: return "br-miss";
+    case counter::page_faults:   return "faults";
+    default:                     return "?";
+    }
+}
+
+// A snapshot of all counters. Missing counters have 'valid[i] == false'
+struct counter_values {
+    double value[counter_count] = {};
+    bool valid[counter_count] = {};
+    double wall_ns = 0;
+};
+
+// CLASS perf_counters. Owns one perf event fd per counter, each opened independently
+// so that a single unsupported event does not disable the others.
+class perf_counters {
+public:
+    perf_counters() {
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            fds_[i] = open_counter(static_cast<counter>(i));
+        }
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters() {
+#if PERF_HARNESS_HAS_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    // Returns true if at least one hardware counter could be opened
+    bool hardware_available() const noexcept {
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            if (static_cast<counter>(i) != counter::page_faults && fds_[i] >= 0) return true;
+        }
+        return false;
+    }
+
+    // Resets and enables all counters
+    void start() {
+#if PERF_HARNESS_HAS_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+        getrusage(RUSAGE_THREAD, &usage_start_);
+#endif
+        clobber_memory();
+        wall_start_ = std::chrono::steady_clock::now();
+    }
+
+    // Disables all counters and returns their values, scaled for multiplexing
+    counter_values stop() {
+        auto wall_stop = std::chrono::steady_clock::now();
+        clobber_memory();
+        counter_values result;
+        result.wall_ns = std::chrono::duration<double, std::nano>(wall_stop - wall_start_).count();
+#if PERF_HARNESS_HAS_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        rusage usage_stop{};
+        getrusage(RUSAGE_THREAD, &usage_stop);
+
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            if (fds_[i] < 0) continue;
+            std::uint64_t data[3] = {};   // value, time_enabled, time_running
+            if (read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            if (data[2] == 0) continue;   // never scheduled on the PMU
+            result.value[i] = static_cast<double>(data[0]) * data[1] / data[2];
+            result.valid[i] = true;
+        }
+
+        const std::size_t faults = static_cast<std::size_t>(counter::page_faults);
+        if (!result.valid[faults]) {
+            result.value[faults] = static_cast<double>(
+                (usage_stop.ru_minflt - usage_start_.ru_minflt) + (usage_stop.ru_majflt - usage_start_.ru_majflt));
+            result.valid[faults] = true;
+        }
+#endif
+        return result;
+    }
+
+private:
+    static int open_counter(counter c) {
+#if PERF_HARNESS_HAS_PERF_EVENT
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        constexpr auto cache_read_miss = [](std::uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        switch (c) {
+        case counter::cycles:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case counter::instructions:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case counter::l1d_misses:
+            attr.type = PERF_TYPE_HW_CACHE; attr.config = cache_read_miss(PERF_COUNT_HW_CACHE_L1D); break;
+        case counter::llc_misses:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case counter::dtlb_misses:
+            attr.type = PERF_TYPE_HW_CACHE; attr.config = cache_read_miss(PERF_COUNT_HW_CACHE_DTLB); break;
+        case counter::branch_misses:
+            attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case counter::page_faults:
+            attr.type = PERF_TYPE_SOFTWARE; attr.config = PERF_COUNT_SW_PAGE_FAULTS; break;
+        default:
+            return -1;
+        }
+
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) {
+            // some sandboxes only allow user-space counting without the exclusion bits
+            attr.exclude_kernel = 0;
+            attr.exclude_hv = 0;
+            fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+        return static_cast<int>(fd);
+#else
+        (void)c;
+        return -1;
+#endif
+    }
+
+private:
+    int fds_[counter_count];
+    std::chrono::steady_clock::time_point wall_start_;
+#if PERF_HARNESS_HAS_PERF_EVENT
+    rusage usage_start_{};
+#endif
+};
+
+// CLASS harness. Runs named benchmarks and prints one row of per-operation counters each.
+class harness {
+public:
+    // 'repetitions' - how many times every benchmark body is run; the fastest run is reported
+    explicit harness(std::size_t repetitions = 5, std::FILE* out = stdout)
+        : repetitions_(repetitions == 0 ? 1 : repetitions), out_(out) {
+        if (!counters_.hardware_available()) {
+            std::fprintf(out_, "# hardware counters unavailable (perf_event_paranoid, container or VM); "
+                               "reporting wall-clock and page faults only\n");
+        }
+        print_header();
+    }
+
+    /* Runs 'body' and reports counters divided by 'ops' (the number of logical operations
+    * the body performs). 'setup' runs before every repetition and is not measured. */
+    template <typename Setup, typename Body>
+    counter_values run(const std::string& name, std::size_t ops, Setup&& setup, Body&& body) {
+        counter_values best;
+        bool have_best = false;
+        for (std::size_t rep = 0; rep < repetitions_; ++rep) {
+            auto state = setup();
+            counters_.start();
+            body(state);
+            counter_values current = counters_.stop();
+            do_not_optimize(state);
+            if (!have_best || current.wall_ns < best.wall_ns) {
+                best = current;
+                have_best = true;
+            }
+        }
+        print_row(name, ops == 0 ? 1 : ops, best);
+        return best;
+    }
+
+    // Same as above, for benchmarks that do not need a separate setup step
+    template <typename Body>
+    counter_values run(const std::string& name, std::size_t ops, Body&& body) {
+        return run(name, ops, [] { return 0; }, [&body](int&) { body(); });
+    }
+
+private:
+    void print_header() {
+        std::fprintf(out_, "%-36s %12s", "benchmark", "ns/op");
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            std::fprintf(out_, " %12s", counter_name(static_cast<counter>(i)));
+        }
+        std::fprintf(out_, " %8s\n", "IPC");
+    }
+
+    void print_row(const std::string& name, std::size_t ops, const counter_values& values) {
+        std::fprintf(out_, "%-36s %12.3f", name.c_str(), values.wall_ns / ops);
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            if (values.valid[i]) {
+                std::fprintf(out_, " %12.4f", values.value[i] / ops);
+            }
+            else {
+                std::fprintf(out_, " %12s", "n/a");
+            }
+        }
+        const std::size_t cycles = static_cast<std::size_t>(counter::cycles);
+        const std::size_t instructions = static_cast<std::size_t>(counter::instructions);
+        if (values.valid[cycles] && values.valid[instructions] && values.value[cycles] > 0) {
+            std::fprintf(out_, " %8.3f\n", values.value[instructions] / values.value[cycles]);
+        }
+        else {
+            std::fprintf(out_, " %8s\n", "n/a");
+        }
+    }
+
+private:
+    std::size_t repetitions_;
+    std::FILE* out_;
+    perf_counters counters_;
+};
+
+} // namespace bench
@@ -0,0 +1,149 @@
+/*
+ * Microbenchmarks for vector operations with hardware counters.
+ *
+ * Build: g++ -std=c++20 -O2 -I. bench/vector_bench.cpp -o vector_bench
+ * Run:   ./vector_bench [element count] [repetitions]
+ */
+
+#include "vector.h"
+#include "vector_hash.h"
+#include "bench/perf_harness.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string>
+
+namespace {
+
+struct heavy {
+    std::string name;
+    std::size_t id = 0;
+
+    heavy() = default;
+    heavy(std::size_t i) : name("element-with-a-long-name-" + std::to_string(i)), id(i) {}
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const std::size_t reps = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+    const std::size_t insert_n = n / 100 > 0 ? n / 100 : 1;
+
+    bench::harness h(reps);
+
+    h.run("push_back<int>", n, [&] {
+        vector<int> v;
+        for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+        bench::do_not_optimize(v.size());
+    });
+
+    h.run("reserve+push_back<int>", n, [&] {
+        vector<int> v;
+        v.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+        bench::do_not_optimize(v.size());
+    });
+
+    h.run("push_back<heavy>", n, [&] {
+        vector<heavy> v;
+        for (std::size_t i = 0; i < n; ++i) v.emplace_back(i);
+        bench::do_not_optimize(v.size());
+    });
+
+    h.run("reserve x2 growth<int>", n,
+        [&] { vector<int> v(n, 1); return v; },
+        [&](vector<int>& v) { v.reserve(v.capacity() * 2); });
+
+    h.run("copy ctor<int>", n,
+        [&] { vector<int> v(n, 1); return v; },
+        [&](vector<int>& v) { vector<int> copy(v); bench::do_not_optimize(copy.size()); });
+
+    h.run("sequential read<int>", n,
+        [&] { vector<int> v(n, 1); return v; },
+        [&](vector<int>& v) {
+            long long sum = 0;
+            for (std::size_t i = 0; i < v.size(); ++i) sum += v[i];
+            bench::do_not_optimize(sum);
+        });
+
+    h.run("insert front<int>", insert_n,
+        [&] { vector<int> v(insert_n, 1); return v; },
+        [&](vector<int>& v) {
+            for (std::size_t i = 0; i < insert_n; ++i) v.insert(v.begin(), static_cast<int>(i));
+        });
+
+    h.run("insert middle<heavy>", insert_n,
+        [&] { vector<heavy> v(insert_n); return v; },
+        [&](vector<heavy>& v) {
+            for (std::size_t i = 0; i < insert_n; ++i) v.insert(v.begin() + v.size() / 2, heavy(i));
+        });
+
+    vector<std::size_t> batch_positions;
+    for (std::size_t i = 0; i < insert_n; ++i) batch_positions.push_back(i * 2);
+    vector<int> batch_values(insert_n, 7);
+    std::span<const std::size_t> batch_span(batch_positions.data(), batch_positions.size());
+
+    h.run("insert sorted batch, one by one<int>", insert_n,
+        [&] { vector<int> v(insert_n * 2, 1); v.reserve(insert_n * 3); return v; },
+        [&](vector<int>& v) {
+            for (std::size_t i = 0; i < insert_n; ++i) v.insert(v.begin() + batch_positions[i] + i, batch_values[i]);
+        });
+
+    h.run("insert_many sorted batch<int>", insert_n,
+        [&] { vector<int> v(insert_n * 2, 1); v.reserve(insert_n * 3); return v; },
+        [&](vector<int>& v) { v.insert_many(batch_span, batch_values.data()); });
+
+    h.run("erase front<int>", insert_n,
+        [&] { vector<int> v(insert_n * 2, 1); return v; },
+        [&](vector<int>& v) {
+            for (std::size_t i = 0; i < insert_n; ++i) v.erase(v.begin());
+        });
+
+    auto random_ids = [&] {
+        vector<std::uint64_t> v;
+        v.reserve(n);
+        std::uint64_t state = 88172645463325252ull;
+        for (std::size_t i = 0; i < n; ++i) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            v.push_back(state >> 16);
+        }
+        return v;
+    };
+
+    h.run("std::sort<u64>", n, random_ids,
+        [&](vector<std::uint64_t>& v) { std::sort(v.data(), v.data() + v.size()); });
+
+    h.run("radix_sort<u64>", n, random_ids,
+        [&](vector<std::uint64_t>& v) { v.radix_sort(); });
+
+    vector<std::uint64_t> ids = random_ids();
+    vector<std::size_t> positions;
+    positions.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) positions.push_back(ids[i] % n);
+    vector<std::uint64_t> gathered(n, 0);
+    std::span<const std::size_t> position_span(positions.data(), positions.size());
+    std::span<std::uint64_t> gathered_span(gathered.data(), gathered.size());
+
+    h.run("operator[] random<u64>", n, [&] {
+        for (std::size_t i = 0; i < n; ++i) gathered[i] = ids[positions[i]];
+        bench::do_not_optimize(gathered[n / 2]);
+    });
+
+    h.run("gather random<u64>", n, [&] {
+        ids.gather(position_span, gathered_span);
+        bench::do_not_optimize(gathered[n / 2]);
+    });
+
+    h.run("std::hash per element<u64>", n, [&] {
+        std::size_t seed = 0;
+        for (std::size_t i = 0; i < n; ++i) seed ^= std::hash<std::uint64_t>()(ids[i]) + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+        bench::do_not_optimize(seed);
+    });
+
+    h.run("fingerprint<u64>", n, [&] { bench::do_not_optimize(fingerprint(ids)); });
+
+    return 0;
+}
@@ -0,0 +1,846 @@
+/*
+ * flat_set<Key> and flat_map<Key, T> - sorted associative containers on top of vector.
+ *
+ * flat_set keeps its keys in one sorted vector; flat_map keeps keys and mapped values in two
+ * parallel vectors, so lookups only touch the densely packed keys. Lookups use a branchless
+ * binary search. insert_range appends the new elements, sorts only them and merges them with
+ * the existing ones in a single linear pass from the back, inside the container's own buffer,
+ * instead of inserting one by one. Only the batch needs scratch space, so repeated batches
+ * reuse the capacity the container already has.
+ *
+ * Heterogeneous lookup (find, contains, count, lower_bound, upper_bound, erase) is enabled
+ * when Compare::is_transparent exists, e.g. with std::less<>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+template <typename Compare>
+concept transparent_compare = requires { typename Compare::is_transparent; };
+
+/* Returns the first element of the sorted range [first, first + n) that is not ordered before 'key'.
+* The loop has a fixed trip count and the comparison selects the next base with a conditional move,
+* so unpredictable keys do not cause branch mispredictions */
+template <typename T, typename K, typename Compare>
+inline const T* branchless_lower_bound(const T* first, std::size_t n, const K& key, const Compare& comp) {
+    if (n == 0) return first;
+    while (n > 1) {
+        std::size_t half = n / 2;
+        first = comp(first[half - 1], key) ? first + half : first;
+        n -= half;
+    }
+    return first + static_cast<std::size_t>(comp(*first, key));
+}
+
+// Returns the first element of the sorted range [first, first + n) ordered after 'key'. Branchless, as above
+template <typename T, typename K, typename Compare>
+inline const T* branchless_upper_bound(const T* first, std::size_t n, const K& key, const Compare& comp) {
+    if (n == 0) return first;
+    while (n > 1) {
+        std::size_t half = n / 2;
+        first = comp(key, first[half - 1]) ? first : first + half;
+        n -= half;
+    }
+    return first + static_cast<std::size_t>(!comp(key, *first));
+}
+
+// CLASS flat_set
+
+template <typename Key, typename Compare = std::less<Key>, typename Alloc = std::allocator<Key>>
+class flat_set {
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using key_type = Key;
+
+    using value_type = Key;
+
+    using key_compare = Compare;
+
+    using container_type = vector<Key, Alloc>;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using iterator = const Key*;
+
+    using const_iterator = const Key*;
+
+    using reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    //  ITERATORS
+
+    [[nodiscard]] const_iterator begin() const noexcept { return keys_.data(); }
+
+    [[nodiscard]] const_iterator end() const noexcept { return keys_.data() + keys_.size(); }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+    [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+    // Default constructor. Constructs an empty set
+    flat_set() = default;
+
+    // Constructs an empty set with the comparator 'comp'
+    explicit flat_set(const Compare& comp) : comp_(comp) {}
+
+    // Constructs the set from the elements of the initializer list, dropping duplicates
+    flat_set(std::initializer_list<Key> ilist, const Compare& comp = Compare());
+
+    // Constructs the set from the range [first, last], dropping duplicates
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    flat_set(InputIt first, InputIt last, const Compare& comp = Compare());
+
+    // Adopts 'keys', sorting them and dropping duplicates
+    explicit flat_set(container_type keys, const Compare& comp = Compare());
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of elements
+    size_type size() const noexcept { return keys_.size(); }
+
+    // Checks if the set has no elements
+    bool empty() const noexcept { return keys_.size() == 0; }
+
+    // Reserves room for 'newcap' elements
+    void reserve(size_type newcap) { if (newcap > keys_.capacity()) keys_.reserve(newcap); }
+
+    // Reduces memory usage by freeing unused memory
+    void shrink_to_fit() { keys_.shrink_to_fit(); }
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+    // Inserts 'key' if it is not present. Returns the position of the key and whether it was inserted
+    std::pair<iterator, bool> insert(const Key& key);
+
+    // Inserts 'key' using move semantics if it is not present
+    std::pair<iterator, bool> insert(Key&& key);
+
+    // Constructs a key from 'args' and inserts it if it is not present
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+
+    /* Inserts the range [first, last] in O(n + k log k): appends, sorts the appended part and merges.
+    * Existing keys win over equivalent new ones, among new ones the first occurrence wins */
+    template <typename InputIt>
+    void insert_range(InputIt first, InputIt last);
+
+    // Inserts the elements of the initializer list, as insert_range
+    void insert_range(std::initializer_list<Key> ilist) { insert_range(ilist.begin(), ilist.end()); }
+
+    // Removes the element at 'pos'
+    iterator erase(const_iterator pos);
+
+    // Removes the key equivalent to 'key'. Returns the number of removed elements
+    size_type erase(const Key& key) { return erase_key(key); }
+
+    // Heterogeneous version of erase(key)
+    template <typename K> requires transparent_compare<Compare>
+    size_type erase(const K& key) { return erase_key(key); }
+
+    // Clears the contents
+    void clear() { keys_.clear(); }
+
+    // Returns the sorted keys and leaves the set empty
+    container_type extract() && { return std::move(keys_); }
+
+    // +++++++++++++++++++ LOOKUP +++++++++++++++++++
+
+    const_iterator find(const Key& key) const { return find_key(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator find(const K& key) const { return find_key(key); }
+
+    bool contains(const Key& key) const { return find_key(key) != end(); }
+
+    template <typename K> requires transparent_compare<Compare>
+    bool contains(const K& key) const { return find_key(key) != end(); }
+
+    size_type count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename K> requires transparent_compare<Compare>
+    size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    const_iterator lower_bound(const Key& key) const { return branchless_lower_bound(begin(), size(), key, comp_); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator lower_bound(const K& key) const { return branchless_lower_bound(begin(), size(), key, comp_); }
+
+    const_iterator upper_bound(const Key& key) const { return branchless_upper_bound(begin(), size(), key, comp_); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator upper_bound(const K& key) const { return branchless_upper_bound(begin(), size(), key, comp_); }
+
+    // +++++++++++++++++++ OBSERVERS +++++++++++++++++++
+
+    // Returns the sorted keys
+    const container_type& keys() const noexcept { return keys_; }
+
+    key_compare key_comp() const { return comp_; }
+
+private:
+    template <typename K>
+    const_iterator find_key(const K& key) const;
+
+    template <typename K>
+    size_type erase_key(const K& key);
+
+    // sorts keys_[old_size, size()) and merges it into keys_[0, old_size)
+    void merge_tail(size_type old_size);
+
+    // merges the unique new keys 'added' into keys_[0, old_size); 'positions[j]' existing keys precede added[j]
+    void merge_back(size_type old_size, container_type& added, const vector<size_type>& positions);
+
+private:
+    container_type keys_;
+    [[no_unique_address]] Compare comp_;
+};
+
+// CLASS flat_map
+
+template <typename Key, typename T, typename Compare = std::less<Key>,
+    typename KeyAlloc = std::allocator<Key>, typename ValueAlloc = std::allocator<T>>
+class flat_map {
+
+    // CLASS base_iterator. Walks the key and value arrays in lockstep
+
+    template <bool IsConst>
+    class base_iterator {
+    public:
+        using mapped_pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::pair<const Key&, std::conditional_t<IsConst, const T&, T&>>;
+        using value_type = std::pair<Key, T>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+
+        // reference is a proxy, so operator-> hands out a pointer-like holder
+        struct pointer {
+            reference ref;
+            const reference* operator->() const { return &ref; }
+        };
+
+        base_iterator() = default;
+        base_iterator(const Key* key, mapped_pointer value) : key_(key), value_(value) {}
+
+        operator base_iterator<true>() const { return base_iterator<true>(key_, value_); }
+
+        reference operator*() const { return reference(*key_, *value_); }
+        pointer operator->() const { return pointer{ **this }; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        base_iterator& operator++() { ++key_; ++value_; return *this; }
+        base_iterator operator++(int) { base_iterator copy = *this; ++*this; return copy; }
+        base_iterator& operator--() { --key_; --value_; return *this; }
+        base_iterator operator--(int) { base_iterator copy = *this; --*this; return copy; }
+        base_iterator& operator+=(difference_type n) { key_ += n; value_ += n; return *this; }
+        base_iterator& operator-=(difference_type n) { key_ -= n; value_ -= n; return *this; }
+        base_iterator operator+(difference_type n) const { base_iterator temp = *this; return temp += n; }
+        base_iterator operator-(difference_type n) const { base_iterator temp = *this; return temp -= n; }
+        difference_type operator-(const base_iterator& other) const { return key_ - other.key_; }
+
+        bool operator==(const base_iterator& other) const { return key_ == other.key_; }
+        bool operator!=(const base_iterator& other) const { return key_ != other.key_; }
+        bool operator<(const base_iterator& other) const { return key_ < other.key_; }
+        bool operator>(const base_iterator& other) const { return key_ > other.key_; }
+        bool operator<=(const base_iterator& other) const { return key_ <= other.key_; }
+        bool operator>=(const base_iterator& other) const { return key_ >= other.key_; }
+
+        // position of the element in keys() / values()
+        const Key* key_ptr() const noexcept { return key_; }
+
+    private:
+        const Key* key_ = nullptr;
+        mapped_pointer value_ = nullptr;
+    };
+
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using key_type = Key;
+
+    using mapped_type = T;
+
+    using value_type = std::pair<Key, T>;
+
+    using key_compare = Compare;
+
+    using key_container_type = vector<Key, KeyAlloc>;
+
+    using mapped_container_type = vector<T, ValueAlloc>;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using iterator = base_iterator<false>;
+
+    using const_iterator = base_iterator<true>;
+
+    //  ITERATORS
+
+    [[nodiscard]] iterator begin() noexcept { return iterator(keys_.data(), values_.data()); }
+
+    [[nodiscard]] iterator end() noexcept { return begin() + size(); }
+
+    [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(keys_.data(), values_.data()); }
+
+    [[nodiscard]] const_iterator end() const noexcept { return begin() + size(); }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+    // Default constructor. Constructs an empty map
+    flat_map() = default;
+
+    // Constructs an empty map with the comparator 'comp'
+    explicit flat_map(const Compare& comp) : comp_(comp) {}
+
+    // Constructs the map from the pairs of the initializer list, the first of equivalent keys wins
+    flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare());
+
+    // Constructs the map from the range of pairs [first, last], the first of equivalent keys wins
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    flat_map(InputIt first, InputIt last, const Compare& comp = Compare());
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+    // Returns the value mapped to 'key', inserting a value-initialized one if there is none
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+    // Returns the value mapped to 'key', inserting a value-initialized one if there is none
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // Returns the value mapped to 'key'. Throws std::out_of_range if there is none
+    T& at(const Key& key);
+
+    // Returns the value mapped to 'key'. Throws std::out_of_range if there is none
+    const T& at(const Key& key) const;
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of elements
+    size_type size() const noexcept { return keys_.size(); }
+
+    // Checks if the map has no elements
+    bool empty() const noexcept { return keys_.size() == 0; }
+
+    // Reserves room for 'newcap' elements
+    void reserve(size_type newcap);
+
+    // Reduces memory usage by freeing unused memory
+    void shrink_to_fit() { keys_.shrink_to_fit(); values_.shrink_to_fit(); }
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+    // Inserts 'value' if its key is not present. Returns the position and whether it was inserted
+    std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+
+    // Inserts 'value' using move semantics if its key is not present
+    std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+    // Constructs a pair from 'args' and inserts it if its key is not present
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+
+    // If 'key' is not present, inserts it with a value constructed from 'args'. Otherwise does nothing
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+
+    // Inserts 'key' with 'value', or assigns 'value' to the existing mapped value
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value);
+
+    /* Inserts the range of pairs [first, last] in O(n + k log k): appends, sorts the appended part and merges.
+    * Existing keys win over equivalent new ones, among new ones the first occurrence wins */
+    template <typename InputIt>
+    void insert_range(InputIt first, InputIt last);
+
+    // Inserts the pairs of the initializer list, as insert_range
+    void insert_range(std::initializer_list<value_type> ilist) { insert_range(ilist.begin(), ilist.end()); }
+
+    // Removes the element at 'pos'
+    iterator erase(const_iterator pos);
+
+    // Removes the element with key equivalent to 'key'. Returns the number of removed elements
+    size_type erase(const Key& key) { return erase_key(key); }
+
+    // Heterogeneous version of erase(key)
+    template <typename K> requires transparent_compare<Compare>
+    size_type erase(const K& key) { return erase_key(key); }
+
+    // Clears the contents
+    void clear() { keys_.clear(); values_.clear(); }
+
+    // +++++++++++++++++++ LOOKUP +++++++++++++++++++
+
+    iterator find(const Key& key) { return begin() + find_index(key); }
+
+    const_iterator find(const Key& key) const { return begin() + find_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    iterator find(const K& key) { return begin() + find_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator find(const K& key) const { return begin() + find_index(key); }
+
+    bool contains(const Key& key) const { return find_index(key) != size(); }
+
+    template <typename K> requires transparent_compare<Compare>
+    bool contains(const K& key) const { return find_index(key) != size(); }
+
+    size_type count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename K> requires transparent_compare<Compare>
+    size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    iterator lower_bound(const Key& key) { return begin() + lower_index(key); }
+
+    const_iterator lower_bound(const Key& key) const { return begin() + lower_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    iterator lower_bound(const K& key) { return begin() + lower_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator lower_bound(const K& key) const { return begin() + lower_index(key); }
+
+    iterator upper_bound(const Key& key) { return begin() + upper_index(key); }
+
+    const_iterator upper_bound(const Key& key) const { return begin() + upper_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    iterator upper_bound(const K& key) { return begin() + upper_index(key); }
+
+    template <typename K> requires transparent_compare<Compare>
+    const_iterator upper_bound(const K& key) const { return begin() + upper_index(key); }
+
+    // +++++++++++++++++++ OBSERVERS +++++++++++++++++++
+
+    // Returns the sorted keys
+    const key_container_type& keys() const noexcept { return keys_; }
+
+    // Returns the mapped values, in key order
+    const mapped_container_type& values() const noexcept { return values_; }
+
+    key_compare key_comp() const { return comp_; }
+
+private:
+    template <typename K>
+    size_type lower_index(const K& key) const {
+        return branchless_lower_bound(keys_.data(), size(), key, comp_) - keys_.data();
+    }
+
+    template <typename K>
+    size_type upper_index(const K& key) const {
+        return branchless_upper_bound(keys_.data(), size(), key, comp_) - keys_.data();
+    }
+
+    // index of the key equivalent to 'key', size() if there is none
+    template <typename K>
+    size_type find_index(const K& key) const;
+
+    template <typename K>
+    size_type erase_key(const K& key);
+
+    // sorts the pairs [old_size, size()) by key and merges them into [0, old_size)
+    void merge_tail(size_type old_size);
+
+    // merges the unique new pairs into [0, old_size); 'positions[j]' existing pairs precede pair j
+    void merge_back(size_type old_size, key_container_type& added_keys, mapped_container_type& added_values,
+        const vector<size_type>& positions);
+
+    // drops the pairs [old_size, size()) after a failed insert_range
+    void truncate(size_type old_size) noexcept;
+
+private:
+    key_container_type keys_;
+    mapped_container_type values_;
+    [[no_unique_address]] Compare comp_;
+};
+
+// +++++++++++++++++++ CLASS flat_set IMPLEMENTATION +++++++++++++++++++
+
+template<typename Key, typename Compare, typename Alloc>
+inline flat_set<Key, Compare, Alloc>::flat_set(std::initializer_list<Key> ilist, const Compare& comp) : comp_(comp) {
+    insert_range(ilist.begin(), ilist.end());
+}
+
+template<typename Key, typename Compare, typename Alloc>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline flat_set<Key, Compare, Alloc>::flat_set(InputIt first, InputIt last, const Compare& comp) : comp_(comp) {
+    insert_range(first, last);
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline flat_set<Key, Compare, Alloc>::flat_set(container_type keys, const Compare& comp) : keys_(std::move(keys)), comp_(comp) {
+    merge_tail(0);
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline std::pair<typename flat_set<Key, Compare, Alloc>::iterator, bool> flat_set<Key, Compare, Alloc>::insert(const Key& key) {
+    size_type index = lower_bound(key) - begin();
+    if (index < size() && !comp_(key, keys_[index])) {
+        return { begin() + index, false };
+    }
+    keys_.insert(keys_.begin() + index, key);
+    return { begin() + index, true };
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline std::pair<typename flat_set<Key, Compare, Alloc>::iterator, bool> flat_set<Key, Compare, Alloc>::insert(Key&& key) {
+    size_type index = lower_bound(key) - begin();
+    if (index < size() && !comp_(key, keys_[index])) {
+        return { begin() + index, false };
+    }
+    keys_.insert(keys_.begin() + index, std::move(key));
+    return { begin() + index, true };
+}
+
+template<typename Key, typename Compare, typename Alloc>
+template<typename... Args>
+inline std::pair<typename flat_set<Key, Compare, Alloc>::iterator, bool> flat_set<Key, Compare, Alloc>::emplace(Args&&... args) {
+    return insert(Key(std::forward<Args>(args)...));
+}
+
+template<typename Key, typename Compare, typename Alloc>
+template<typename InputIt>
+inline void flat_set<Key, Compare, Alloc>::insert_range(InputIt first, InputIt last) {
+    const size_type old_size = size();
+    VECTOR_TRY {
+        if constexpr (std::forward_iterator<InputIt>) {
+            keys_.reserve(old_size + static_cast<size_type>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            keys_.emplace_back(*first);
+        }
+        merge_tail(old_size);
+    }
+    VECTOR_CATCH(...) {
+        keys_.erase(keys_.begin() + old_size, keys_.end());
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline flat_set<Key, Compare, Alloc>::iterator flat_set<Key, Compare, Alloc>::erase(const_iterator pos) {
+    size_type index = pos - begin();
+    keys_.erase(keys_.begin() + index);
+    return begin() + index;
+}
+
+template<typename Key, typename Compare, typename Alloc>
+template<typename K>
+inline flat_set<Key, Compare, Alloc>::const_iterator flat_set<Key, Compare, Alloc>::find_key(const K& key) const {
+    const_iterator it = branchless_lower_bound(begin(), size(), key, comp_);
+    return (it != end() && !comp_(key, *it)) ? it : end();
+}
+
+template<typename Key, typename Compare, typename Alloc>
+template<typename K>
+inline std::size_t flat_set<Key, Compare, Alloc>::erase_key(const K& key) {
+    const_iterator it = find_key(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline void flat_set<Key, Compare, Alloc>::merge_tail(size_type old_size) {
+    const size_type total = size();
+    if (total == old_size) return;
+    Key* base = keys_.data();
+    std::stable_sort(base + old_size, base + total, comp_);
+
+    // drops new keys equivalent to an existing one or to an earlier new one, and finds where the rest go
+    vector<size_type> positions;
+    positions.reserve(total - old_size);
+    size_type kept = old_size;
+    for (size_type i = 0, j = old_size; j < total; ++j) {
+        while (i < old_size && comp_(base[i], base[j])) ++i;
+        if ((i < old_size && !comp_(base[j], base[i])) || (kept > old_size && !comp_(base[kept - 1], base[j]))) {
+            continue;
+        }
+        if (kept != j) base[kept] = std::move(base[j]);
+        ++kept;
+        positions.push_back(i);
+    }
+    keys_.erase(keys_.begin() + kept, keys_.end());
+
+    // new keys that all sort after the existing ones are in place already
+    if (positions.size() == 0 || positions[0] == old_size) return;
+    container_type added(std::make_move_iterator(keys_.begin() + old_size), std::make_move_iterator(keys_.end()));
+    merge_back(old_size, added, positions);
+}
+
+template<typename Key, typename Compare, typename Alloc>
+inline void flat_set<Key, Compare, Alloc>::merge_back(size_type old_size, container_type& added, const vector<size_type>& positions) {
+    Key* base = keys_.data();
+    if constexpr (std::is_nothrow_move_assignable_v<Key>) {
+        // from the back: existing keys only move right and land on slots already read
+        size_type out = keys_.size(), i = old_size;
+        for (size_type j = positions.size(); j-- > 0;) {
+            while (i > positions[j]) base[--out] = std::move(base[--i]);
+            base[--out] = std::move(added[j]);
+        }
+    }
+    else {
+        // a throwing move could leave the keys half merged: build the result aside (strong guarantee)
+        container_type merged;
+        merged.reserve(keys_.size());
+        size_type i = 0;
+        for (size_type j = 0; j < positions.size(); ++j) {
+            for (; i < positions[j]; ++i) merged.push_back(std::move_if_noexcept(base[i]));
+            merged.push_back(std::move_if_noexcept(added[j]));
+        }
+        for (; i < old_size; ++i) merged.push_back(std::move_if_noexcept(base[i]));
+        keys_ = std::move(merged);
+    }
+}
+
+// +++++++++++++++++++ CLASS flat_map IMPLEMENTATION +++++++++++++++++++
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::flat_map(std::initializer_list<value_type> ilist, const Compare& comp) : comp_(comp) {
+    insert_range(ilist.begin(), ilist.end());
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::flat_map(InputIt first, InputIt last, const Compare& comp) : comp_(comp) {
+    insert_range(first, last);
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline T& flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::at(const Key& key) {
+    size_type index = find_index(key);
+    if (index == size()) {
+        VECTOR_THROW(std::out_of_range("key not found"));
+    }
+    return values_[index];
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline const T& flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::at(const Key& key) const {
+    size_type index = find_index(key);
+    if (index == size()) {
+        VECTOR_THROW(std::out_of_range("key not found"));
+    }
+    return values_[index];
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline void flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::reserve(size_type newcap) {
+    if (newcap > keys_.capacity()) keys_.reserve(newcap);
+    if (newcap > values_.capacity()) values_.reserve(newcap);
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename... Args>
+inline std::pair<typename flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::iterator, bool>
+flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    return try_emplace(std::move(value.first), std::move(value.second));
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename K, typename... Args>
+inline std::pair<typename flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::iterator, bool>
+flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::try_emplace(K&& key, Args&&... args) {
+    size_type index = lower_index(key);
+    if (index < size() && !comp_(key, keys_[index])) {
+        return { begin() + index, false };
+    }
+    keys_.insert(keys_.begin() + index, Key(std::forward<K>(key)));
+    VECTOR_TRY {
+        values_.insert(values_.begin() + index, T(std::forward<Args>(args)...));
+    }
+    VECTOR_CATCH(...) {
+        keys_.erase(keys_.begin() + index);
+        VECTOR_RETHROW;
+    }
+    return { begin() + index, true };
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename K, typename M>
+inline std::pair<typename flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::iterator, bool>
+flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::insert_or_assign(K&& key, M&& value) {
+    size_type index = lower_index(key);
+    if (index < size() && !comp_(key, keys_[index])) {
+        values_[index] = std::forward<M>(value);
+        return { begin() + index, false };
+    }
+    return try_emplace(std::forward<K>(key), std::forward<M>(value));
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename InputIt>
+inline void flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::insert_range(InputIt first, InputIt last) {
+    const size_type old_size = size();
+    VECTOR_TRY {
+        if constexpr (std::forward_iterator<InputIt>) {
+            const size_type count = static_cast<size_type>(std::distance(first, last));
+            keys_.reserve(old_size + count);
+            values_.reserve(old_size + count);
+        }
+        for (; first != last; ++first) {
+            auto&& pair = *first;
+            keys_.emplace_back(std::get<0>(std::forward<decltype(pair)>(pair)));
+            values_.emplace_back(std::get<1>(std::forward<decltype(pair)>(pair)));
+        }
+        merge_tail(old_size);
+    }
+    VECTOR_CATCH(...) {
+        truncate(old_size);
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::iterator
+flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::erase(const_iterator pos) {
+    size_type index = pos.key_ptr() - keys_.data();
+    keys_.erase(keys_.begin() + index);
+    values_.erase(values_.begin() + index);
+    return begin() + index;
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename K>
+inline std::size_t flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::find_index(const K& key) const {
+    size_type index = lower_index(key);
+    return (index < size() && !comp_(key, keys_[index])) ? index : size();
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template<typename K>
+inline std::size_t flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::erase_key(const K& key) {
+    size_type index = find_index(key);
+    if (index == size()) return 0;
+    erase(begin() + index);
+    return 1;
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline void flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::merge_tail(size_type old_size) {
+    // keys and values stay in separate arrays, so the new part is sorted through a permutation
+    const size_type total = size();
+    if (total == old_size) return;
+    vector<size_type> order;
+    order.reserve(total - old_size);
+    for (size_type i = old_size; i < total; ++i) {
+        order.push_back(i);
+    }
+    size_type* order_first = order.data();
+    std::stable_sort(order_first, order_first + order.size(),
+        [this](size_type lhs, size_type rhs) { return comp_(keys_[lhs], keys_[rhs]); });
+
+    // drops new pairs whose key is equivalent to an existing one or to an earlier new one, and finds where the rest go
+    vector<size_type> positions;
+    positions.reserve(order.size());
+    size_type kept = 0;
+    for (size_type i = 0, j = 0; j < order.size(); ++j) {
+        const Key& key = keys_[order[j]];
+        while (i < old_size && comp_(keys_[i], key)) ++i;
+        if ((i < old_size && !comp_(key, keys_[i])) || (kept > 0 && !comp_(keys_[order[kept - 1]], key))) {
+            continue;
+        }
+        order[kept++] = order[j];
+        positions.push_back(i);
+    }
+
+    key_container_type added_keys;
+    mapped_container_type added_values;
+    added_keys.reserve(kept);
+    added_values.reserve(kept);
+    for (size_type j = 0; j < kept; ++j) {
+        added_keys.push_back(std::move(keys_[order[j]]));
+        added_values.push_back(std::move(values_[order[j]]));
+    }
+    truncate(old_size + kept);
+    merge_back(old_size, added_keys, added_values, positions);
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline void flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::merge_back(size_type old_size, key_container_type& added_keys,
+    mapped_container_type& added_values, const vector<size_type>& positions) {
+    Key* keys = keys_.data();
+    T* values = values_.data();
+    if constexpr (std::is_nothrow_move_assignable_v<Key> && std::is_nothrow_move_assignable_v<T>) {
+        // from the back: existing pairs only move right and land on slots already read
+        size_type out = keys_.size(), i = old_size;
+        for (size_type j = positions.size(); j-- > 0;) {
+            for (; i > positions[j]; --out) {
+                --i;
+                keys[out - 1] = std::move(keys[i]);
+                values[out - 1] = std::move(values[i]);
+            }
+            --out;
+            keys[out] = std::move(added_keys[j]);
+            values[out] = std::move(added_values[j]);
+        }
+    }
+    else {
+        // a throwing move could leave the pairs half merged: build the result aside (strong guarantee)
+        key_container_type merged_keys;
+        mapped_container_type merged_values;
+        merged_keys.reserve(keys_.size());
+        merged_values.reserve(keys_.size());
+        size_type i = 0;
+        auto append = [&](Key& key, T& value) {
+            merged_keys.push_back(std::move_if_noexcept(key));
+            merged_values.push_back(std::move_if_noexcept(value));
+        };
+        for (size_type j = 0; j < positions.size(); ++j) {
+            for (; i < positions[j]; ++i) append(keys[i], values[i]);
+            append(added_keys[j], added_values[j]);
+        }
+        for (; i < old_size; ++i) append(keys[i], values[i]);
+        keys_ = std::move(merged_keys);
+        values_ = std::move(merged_values);
+    }
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+inline void flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>::truncate(size_type old_size) noexcept {
+    while (keys_.size() > old_size) keys_.pop_back();
+    while (values_.size() > old_size) values_.pop_back();
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename Key, typename Compare, typename Alloc>
+[[nodiscard]]
+inline bool operator==(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return lhs.keys() == rhs.keys();
+}
+
+template<typename Key, typename T, typename Compare, typename KeyAlloc, typename ValueAlloc>
+[[nodiscard]]
+inline bool operator==(const flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>& lhs, const flat_map<Key, T, Compare, KeyAlloc, ValueAlloc>& rhs) {
+    return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+}
@@ -0,0 +1,685 @@
+/*
+ * inplace_vector<T, N> - a vector with fixed capacity N and inline storage.
+ *
+ * Never allocates: the elements live in an aligned array inside the object. Growing past N
+ * either throws std::bad_alloc (push_back, emplace_back, insert, assign, resize) or reports the
+ * failure through the return value (try_push_back, try_emplace_back).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector_exceptions.h"
+
+template <typename T, std::size_t N>
+class inplace_vector {
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using reference = value_type&;
+
+    using const_reference = const value_type&;
+
+    using pointer = value_type*;
+
+    using const_pointer = const value_type*;
+
+    using iterator = T*;
+
+    using const_iterator = const T*;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    //  ITERATORS
+
+    // returns a read / write iterator that points to the first element
+    [[nodiscard]] iterator begin() noexcept { return data(); }
+
+    // returns a read / write iterator that points one past the last element
+    [[nodiscard]] iterator end() noexcept { return data() + sz_; }
+
+    // returns a read - only (constant) iterator that points to the first element
+    [[nodiscard]] const_iterator begin()   const noexcept { return data(); }
+
+    // returns a read - only (constant) iterator that points one past the last element
+    [[nodiscard]] const_iterator end()     const noexcept { return data() + sz_; }
+
+    // returns a read - only (constant) iterator that points to the first element
+    [[nodiscard]] const_iterator cbegin()  const noexcept { return data(); }
+
+    // returns a read - only (constant) iterator that points one past the last element
+    [[nodiscard]] const_iterator cend()    const noexcept { return data() + sz_; }
+
+    // returns a read / write reverse iterator that points to the last element
+    [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+
+    // returns a read / write reverse iterator that points to one before the first element
+    [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+
+    // returns a read - only (constant) reverse iterator that points to the last element
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+    // returns a read - only (constant) reverse iterator that points to one before the first element
+    [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // returns a read - only (constant) reverse iterator that points to the last element
+    [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+
+    // returns a read - only (constant) reverse iterator that points to one before the first element
+    [[nodiscard]] const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // +++++++++++++++++++ CONSTRUCTORS, DTOR +++++++++++++++++++
+    // strong exception guarantee
+
+    // Default constructor. Constructs an empty container
+    inplace_vector() noexcept = default;
+
+    // Constructs the container with 'sz' default-inserted instances of T. Throws std::bad_alloc if sz > N
+    explicit inplace_vector(size_type sz);
+
+    // Constructs the container with 'sz' copies of 'value'. Throws std::bad_alloc if sz > N
+    inplace_vector(size_type sz, const_reference value);
+
+    // Constructs the container with the contents of the initializer list
+    inplace_vector(std::initializer_list<T>);
+
+    // Constructs the container with the contents of the range [first, last]
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    inplace_vector(InputIt first, InputIt last);
+
+    // Copy constructor
+    inplace_vector(const inplace_vector&);
+
+    // Move constructor. Moves the elements one by one, 'other' keeps its (moved-from) elements
+    inplace_vector(inplace_vector&&) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+    // A Destructor. Destroys the elements
+    ~inplace_vector() noexcept;
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+    // Returns a read - write reference to the element at 'index'. No bounds checking is performed.
+    reference operator[](size_type index) noexcept { return data()[index]; }
+
+    // Returns a read - only reference to the element at 'index'. No bounds checking is performed.
+    const_reference operator[](size_type index) const noexcept { return data()[index]; }
+
+    // Returns a read - write reference to the element at 'index', with bounds checking.
+    reference at(size_type index);
+
+    // Returns a read - only reference to the element at 'index', with bounds checking.
+    const_reference at(size_type index) const;
+
+    // Returns a read - write reference to the first element
+    reference front() noexcept { return data()[0]; }
+
+    // Returns a read - only reference to the first element
+    const_reference front() const noexcept { return data()[0]; }
+
+    // Returns a read - write reference to the last element
+    reference back() noexcept { return data()[sz_ - 1]; }
+
+    // Returns a read - only reference to the last element
+    const_reference back() const noexcept { return data()[sz_ - 1]; }
+
+    // Returns a pointer to the inline storage
+    pointer data() noexcept {
+        // std::launder needs an object at the address, so an empty container hands out the raw storage
+        return sz_ == 0 ? reinterpret_cast<T*>(storage_) : std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    // Returns a read - only pointer to the inline storage
+    const_pointer data() const noexcept {
+        return sz_ == 0 ? reinterpret_cast<const T*>(storage_) : std::launder(reinterpret_cast<const T*>(storage_));
+    }
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of elements in the container
+    size_type size() const noexcept { return sz_; }
+
+    // Returns N
+    static constexpr size_type capacity() noexcept { return N; }
+
+    // Returns N
+    static constexpr size_type max_size() noexcept { return N; }
+
+    // Checks if the container has no elements
+    bool empty() const noexcept { return sz_ == 0; }
+
+    // Checks if the container holds N elements
+    bool full() const noexcept { return sz_ == N; }
+
+    // Throws std::bad_alloc if 'newcap' > N, does nothing otherwise
+    static void reserve(size_type newcap);
+
+    // Does nothing, the storage is inline
+    static void shrink_to_fit() noexcept {}
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+    // Appends a new element. Throws std::bad_alloc if the container is full
+    template <typename... Args>
+    reference emplace_back(Args&&... args);
+
+    // Appends a copy of 'value'. Throws std::bad_alloc if the container is full
+    void push_back(const value_type& value);
+
+    // Appends 'value' using move semantics. Throws std::bad_alloc if the container is full
+    void push_back(value_type&& value);
+
+    // Appends a new element and returns a pointer to it, or nullptr if the container is full
+    template <typename... Args>
+    pointer try_emplace_back(Args&&... args);
+
+    // Appends a copy of 'value' and returns a pointer to it, or nullptr if the container is full
+    pointer try_push_back(const value_type& value);
+
+    // Appends 'value' using move semantics and returns a pointer to it, or nullptr if the container is full
+    pointer try_push_back(value_type&& value);
+
+    // Appends a new element. The behaviour is undefined if the container is full
+    template <typename... Args>
+    reference unchecked_emplace_back(Args&&... args);
+
+    // Inserts a copy of 'value' before 'pos'. Throws std::bad_alloc if the container is full
+    iterator insert(const_iterator pos, const T& value);
+
+    // Inserts 'value' before 'pos' using move semantics. Throws std::bad_alloc if the container is full
+    iterator insert(const_iterator pos, T&& value);
+
+    // Inserts 'count' copies of 'value' before 'pos'. Throws std::bad_alloc if they do not fit
+    iterator insert(const_iterator pos, size_type count, const T& value);
+
+    // Inserts the elements of the range [first, last] before 'pos'. Throws std::bad_alloc if they do not fit
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    iterator insert(const_iterator pos, InputIt first, InputIt last);
+
+    // Inserts the elements of the initializer list before 'pos'. Throws std::bad_alloc if they do not fit
+    iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+
+    // Constructs a new element before 'pos'. Throws std::bad_alloc if the container is full
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args);
+
+    // Removes the last element
+    void pop_back() noexcept;
+
+    // Clears the contents
+    void clear() noexcept;
+
+    // Changes the number of elements stored. Throws std::bad_alloc if 'count' > N
+    void resize(size_type count);
+
+    // Changes the number of elements stored, appending copies of 'value'. Throws std::bad_alloc if 'count' > N
+    void resize(size_type count, const value_type& value);
+
+    // Removes the element at 'pos'
+    iterator erase(const_iterator pos);
+
+    // Removes the elements in the range [first, last]
+    iterator erase(const_iterator first, const_iterator last);
+
+    // Swaps the contents element by element
+    void swap(inplace_vector&) noexcept(std::is_nothrow_swappable_v<T> && std::is_nothrow_move_constructible_v<T>);
+
+    // MEMBER FUNCTIONS
+
+    // Copy assignment operator
+    inplace_vector& operator=(const inplace_vector&);
+
+    // Move assignment operator
+    inplace_vector& operator=(inplace_vector&&) noexcept(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>);
+
+    // Replaces the contents with 'count' copies of 'value'. Throws std::bad_alloc if 'count' > N
+    void assign(size_type count, const T& value);
+
+    // Replaces the contents with the range [first, last]. Throws std::bad_alloc if it does not fit
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    void assign(InputIt first, InputIt last);
+
+    // Replaces the contents with the elements of the initializer list. Throws std::bad_alloc if they do not fit
+    void assign(std::initializer_list<T> ilist);
+
+private:
+    // throws std::bad_alloc if 'count' elements do not fit
+    static void check_capacity(size_type count);
+
+    // constructs the elements of [first, last] at the end, rolling back on exception
+    template <typename InputIt>
+    void append_range(InputIt first, InputIt last);
+
+    // rotates the elements from 'old_size' to the end into position 'index'
+    iterator rotate_into(size_type index, size_type old_size);
+
+    // throws std::out_of_range unless 'pos' is in [begin(), end()]
+    size_type check_position(const_iterator pos) const;
+
+private:
+    alignas(T) unsigned char storage_[N == 0 ? 1 : N * sizeof(T)];
+    size_type sz_ = 0;
+};
+
+// +++++++++++++++++++ CLASS inplace_vector IMPLEMENTATION +++++++++++++++++++
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::inplace_vector(size_type sz) {
+    check_capacity(sz);
+    VECTOR_TRY {
+        for (; sz_ < sz; ++sz_) {
+            std::construct_at(data() + sz_);
+        }
+    }
+    VECTOR_CATCH(...) {
+        clear();
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::inplace_vector(size_type sz, const_reference value) {
+    check_capacity(sz);
+    VECTOR_TRY {
+        for (; sz_ < sz; ++sz_) {
+            std::construct_at(data() + sz_, value);
+        }
+    }
+    VECTOR_CATCH(...) {
+        clear();
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::inplace_vector(std::initializer_list<T> init_list) {
+    append_range(init_list.begin(), init_list.end());
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline inplace_vector<T, N>::inplace_vector(InputIt first, InputIt last) {
+    append_range(first, last);
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::inplace_vector(const inplace_vector& other) {
+    append_range(other.begin(), other.end());
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::inplace_vector(inplace_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    append_range(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::~inplace_vector() noexcept {
+    clear();
+}
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+template<typename T, std::size_t N>
+inline T& inplace_vector<T, N>::at(size_type index) {
+    if (index >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return data()[index];
+}
+
+template<typename T, std::size_t N>
+inline const T& inplace_vector<T, N>::at(size_type index) const {
+    if (index >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return data()[index];
+}
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::reserve(size_type newcap) {
+    check_capacity(newcap);
+}
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+template<typename T, std::size_t N>
+template<typename... Args>
+inline T& inplace_vector<T, N>::emplace_back(Args&&... args) {
+    check_capacity(sz_ + 1);
+    return unchecked_emplace_back(std::forward<Args>(args)...);
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::push_back(const value_type& value) {
+    emplace_back(value);
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::push_back(value_type&& value) {
+    emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+inline T* inplace_vector<T, N>::try_emplace_back(Args&&... args) {
+    if (sz_ == N) {
+        return nullptr;
+    }
+    return std::addressof(unchecked_emplace_back(std::forward<Args>(args)...));
+}
+
+template<typename T, std::size_t N>
+inline T* inplace_vector<T, N>::try_push_back(const value_type& value) {
+    return try_emplace_back(value);
+}
+
+template<typename T, std::size_t N>
+inline T* inplace_vector<T, N>::try_push_back(value_type&& value) {
+    return try_emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+inline T& inplace_vector<T, N>::unchecked_emplace_back(Args&&... args) {
+    T* slot = std::construct_at(data() + sz_, std::forward<Args>(args)...);
+    ++sz_;
+    return *slot;
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::insert(const_iterator pos, size_type count, const T& value) {
+    size_type index = check_position(pos);
+    check_capacity(sz_ + count);
+    size_type old_sz = sz_;
+    // 'value' may be one of our elements; appending never moves them
+    resize(sz_ + count, value);
+    return rotate_into(index, old_sz);
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::insert(const_iterator pos, InputIt first, InputIt last) {
+    size_type index = check_position(pos);
+    if constexpr (std::forward_iterator<InputIt>) {
+        check_capacity(sz_ + static_cast<size_type>(std::distance(first, last)));
+    }
+    size_type old_sz = sz_;
+    append_range(first, last);
+    return rotate_into(index, old_sz);
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::insert(const_iterator pos, std::initializer_list<T> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::emplace(const_iterator pos, Args&&... args) {
+    size_type index = check_position(pos);
+    emplace_back(std::forward<Args>(args)...);
+    return rotate_into(index, sz_ - 1);
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::pop_back() noexcept {
+    if (sz_ > 0) {
+        --sz_;
+        std::destroy_at(data() + sz_);
+    }
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::clear() noexcept {
+    std::destroy(data(), data() + sz_);
+    sz_ = 0;
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::resize(size_type count) {
+    check_capacity(count);
+    if (count < sz_) {
+        std::destroy(data() + count, data() + sz_);
+        sz_ = count;
+        return;
+    }
+    size_type old_sz = sz_;
+    VECTOR_TRY {
+        for (; sz_ < count; ++sz_) {
+            std::construct_at(data() + sz_);
+        }
+    }
+    VECTOR_CATCH(...) {
+        std::destroy(data() + old_sz, data() + sz_);
+        sz_ = old_sz;
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::resize(size_type count, const value_type& value) {
+    check_capacity(count);
+    if (count < sz_) {
+        std::destroy(data() + count, data() + sz_);
+        sz_ = count;
+        return;
+    }
+    size_type old_sz = sz_;
+    VECTOR_TRY {
+        for (; sz_ < count; ++sz_) {
+            std::construct_at(data() + sz_, value);
+        }
+    }
+    VECTOR_CATCH(...) {
+        std::destroy(data() + old_sz, data() + sz_);
+        sz_ = old_sz;
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::erase(const_iterator pos) {
+    return erase(pos, pos + 1);
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::erase(const_iterator first, const_iterator last) {
+    if (first < cbegin() || last > cend() || first > last) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
+    }
+    iterator dest = begin() + (first - cbegin());
+    iterator new_end = std::move(begin() + (last - cbegin()), end(), dest);
+    std::destroy(new_end, end());
+    sz_ = new_end - begin();
+    return dest;
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::swap(inplace_vector& other)
+    noexcept(std::is_nothrow_swappable_v<T> && std::is_nothrow_move_constructible_v<T>) {
+    inplace_vector& shorter = sz_ < other.sz_ ? *this : other;
+    inplace_vector& longer = sz_ < other.sz_ ? other : *this;
+    std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+    size_type common = shorter.sz_;
+    for (size_type i = common; i < longer.sz_; ++i) {
+        shorter.unchecked_emplace_back(std::move(longer[i]));
+    }
+    std::destroy(longer.begin() + common, longer.end());
+    longer.sz_ = common;
+}
+
+    // +++++++++++++++++++ MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>& inplace_vector<T, N>::operator=(const inplace_vector& other) {
+    if (this == &other) return *this;
+    size_type common = std::min(sz_, other.sz_);
+    std::copy(other.begin(), other.begin() + common, begin());
+    if (other.sz_ < sz_) {
+        std::destroy(begin() + other.sz_, end());
+        sz_ = other.sz_;
+    }
+    else {
+        append_range(other.begin() + common, other.end());
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>& inplace_vector<T, N>::operator=(inplace_vector&& other)
+    noexcept(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>) {
+    if (this == &other) return *this;
+    size_type common = std::min(sz_, other.sz_);
+    std::move(other.begin(), other.begin() + common, begin());
+    if (other.sz_ < sz_) {
+        std::destroy(begin() + other.sz_, end());
+        sz_ = other.sz_;
+    }
+    else {
+        append_range(std::make_move_iterator(other.begin() + common), std::make_move_iterator(other.end()));
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::assign(size_type count, const T& value) {
+    check_capacity(count);
+    clear();
+    resize(count, value);
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline void inplace_vector<T, N>::assign(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) {
+        // the old contents survive a range that is too long
+        check_capacity(static_cast<size_type>(std::distance(first, last)));
+    }
+    clear();
+    append_range(first, last);
+}
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::assign(std::initializer_list<T> ilist) {
+    assign(ilist.begin(), ilist.end());
+}
+
+    // OTHER (private methods - helpers)
+
+template<typename T, std::size_t N>
+inline void inplace_vector<T, N>::check_capacity(size_type count) {
+    if (count > N) {
+        VECTOR_THROW(std::bad_alloc());
+    }
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt>
+inline void inplace_vector<T, N>::append_range(InputIt first, InputIt last) {
+    size_type old_sz = sz_;
+    VECTOR_TRY {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+    VECTOR_CATCH(...) {
+        std::destroy(data() + old_sz, data() + sz_);
+        sz_ = old_sz;
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::iterator inplace_vector<T, N>::rotate_into(size_type index, size_type old_size) {
+    std::rotate(begin() + index, begin() + old_size, end());
+    return begin() + index;
+}
+
+template<typename T, std::size_t N>
+inline inplace_vector<T, N>::size_type inplace_vector<T, N>::check_position(const_iterator pos) const {
+    if (pos < cbegin() || pos > cend()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
+    }
+    return static_cast<size_type>(pos - cbegin());
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator==(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+// based on operator==
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator!=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator<(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size();
+    }
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+// based on operator<
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator>(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    return rhs < lhs;
+}
+
+// based on operator<
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator<=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    return !(rhs < lhs);
+}
+
+// based on operator<
+template<typename T, std::size_t N>
+[[nodiscard]]
+inline bool operator>=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs) {
+    return !(lhs < rhs);
+}
+
+template<typename T, std::size_t N>
+inline void swap(inplace_vector<T, N>& lhs, inplace_vector<T, N>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
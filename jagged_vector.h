@@ -0,0 +1,376 @@
+/*
+ * jagged_vector<T> - many variable-length rows in compressed sparse row (CSR) layout.
+ *
+ * All elements live back to back in one vector<T>; row r is [offsets[r], offsets[r + 1]) of it.
+ * Compared to vector<vector<T>> this costs one size_type per row instead of a separate heap
+ * block with its own header, and neighbouring rows are adjacent in memory. Rows are appended
+ * at the end (push_row) and only the last row can grow (append).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vector.h"
+
+template <typename T, typename Alloc = std::allocator<T>>
+class jagged_vector {
+
+    // CLASS base_iterator. Iterates over the rows as spans
+
+    template <bool IsConst>
+    class base_iterator {
+    public:
+        using owner_pointer = std::conditional_t<IsConst, const jagged_vector*, jagged_vector*>;
+        using value_type = std::span<std::conditional_t<IsConst, const T, T>>;
+        using reference = value_type;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+
+        constexpr base_iterator() = default;
+        constexpr base_iterator(owner_pointer owner, std::size_t row) : owner_(owner), row_(row) {}
+
+        constexpr operator base_iterator<true>() const { return base_iterator<true>(owner_, row_); }
+
+        constexpr reference operator*() const { return (*owner_)[row_]; }
+        constexpr reference operator[](difference_type n) const { return (*owner_)[row_ + n]; }
+
+        constexpr base_iterator& operator++() { ++row_; return *this; }
+        constexpr base_iterator operator++(int) { base_iterator copy = *this; ++row_; return copy; }
+        constexpr base_iterator& operator--() { --row_; return *this; }
+        constexpr base_iterator operator--(int) { base_iterator copy = *this; --row_; return copy; }
+        constexpr base_iterator& operator+=(difference_type n) { row_ += n; return *this; }
+        constexpr base_iterator& operator-=(difference_type n) { row_ -= n; return *this; }
+        constexpr base_iterator operator+(difference_type n) const { return base_iterator(owner_, row_ + n); }
+        constexpr base_iterator operator-(difference_type n) const { return base_iterator(owner_, row_ - n); }
+        constexpr difference_type operator-(const base_iterator& other) const {
+            return static_cast<difference_type>(row_) - static_cast<difference_type>(other.row_);
+        }
+
+        constexpr bool operator==(const base_iterator& other) const { return row_ == other.row_; }
+        constexpr bool operator!=(const base_iterator& other) const { return row_ != other.row_; }
+        constexpr bool operator<(const base_iterator& other) const { return row_ < other.row_; }
+
+    private:
+        owner_pointer owner_ = nullptr;
+        std::size_t row_ = 0;
+    };
+
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = T;
+
+    using allocator_type = Alloc;
+
+    using size_type = std::size_t;
+
+    using row_type = std::span<T>;
+
+    using const_row_type = std::span<const T>;
+
+    using values_type = vector<T, Alloc>;
+
+    using offsets_type = vector<size_type, typename std::allocator_traits<Alloc>::template rebind_alloc<size_type>>;
+
+    using iterator = base_iterator<false>;
+
+    using const_iterator = base_iterator<true>;
+
+    //  ITERATORS
+
+    [[nodiscard]] constexpr iterator begin() { return iterator(this, 0); }
+
+    [[nodiscard]] constexpr iterator end() { return iterator(this, size()); }
+
+    [[nodiscard]] constexpr const_iterator begin() const { return const_iterator(this, 0); }
+
+    [[nodiscard]] constexpr const_iterator end() const { return const_iterator(this, size()); }
+
+    [[nodiscard]] constexpr const_iterator cbegin() const { return begin(); }
+
+    [[nodiscard]] constexpr const_iterator cend() const { return end(); }
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+    // Default constructor. Constructs a container without rows
+    constexpr jagged_vector() { offsets_.push_back(0); }
+
+    // Copies the rows of a vector of vectors into one contiguous buffer
+    template <typename RowAlloc, typename OuterAlloc>
+    constexpr explicit jagged_vector(const vector<vector<T, RowAlloc>, OuterAlloc>& rows);
+
+    // Constructs the container from a list of rows
+    constexpr jagged_vector(std::initializer_list<std::initializer_list<T>> rows);
+
+    constexpr jagged_vector(const jagged_vector&) = default;
+
+    /* Move constructor. 'other' is left without rows, which takes a fresh offsets buffer holding
+    * the leading 0, so unlike the move assignment it may throw std::bad_alloc */
+    constexpr jagged_vector(jagged_vector&& other);
+
+    constexpr jagged_vector& operator=(const jagged_vector&) = default;
+
+    // Move assignment. 'other' is left without rows, reusing the offsets buffer of this container
+    constexpr jagged_vector& operator=(jagged_vector&& other) noexcept(std::is_nothrow_move_assignable_v<values_type>);
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+    // Returns row 'row'. No bounds checking is performed.
+    constexpr row_type operator[](size_type row) noexcept {
+        return row_type(values_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]);
+    }
+
+    // Returns row 'row'. No bounds checking is performed.
+    constexpr const_row_type operator[](size_type row) const noexcept {
+        return const_row_type(values_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]);
+    }
+
+    // Returns row 'row', with bounds checking.
+    constexpr row_type at(size_type row);
+
+    // Returns row 'row', with bounds checking.
+    constexpr const_row_type at(size_type row) const;
+
+    // Returns the last row
+    constexpr row_type back() noexcept { return (*this)[size() - 1]; }
+
+    // Returns the last row
+    constexpr const_row_type back() const noexcept { return (*this)[size() - 1]; }
+
+    // Returns all elements, row after row
+    constexpr const values_type& values() const noexcept { return values_; }
+
+    // Returns the row offsets: size() + 1 entries, starting with 0
+    constexpr const offsets_type& offsets() const noexcept { return offsets_; }
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of rows
+    constexpr size_type size() const noexcept { return offsets_.size() - 1; }
+
+    // Checks if there are no rows
+    constexpr bool empty() const noexcept { return size() == 0; }
+
+    // Returns the number of elements in row 'row'
+    constexpr size_type row_size(size_type row) const noexcept { return offsets_[row + 1] - offsets_[row]; }
+
+    // Returns the number of elements in all rows
+    constexpr size_type total_size() const noexcept { return values_.size(); }
+
+    // Reserves room for 'rows' rows holding 'values' elements in total
+    constexpr void reserve(size_type rows, size_type values);
+
+    // Reduces memory usage by freeing unused memory
+    constexpr void shrink_to_fit() { values_.shrink_to_fit(); offsets_.shrink_to_fit(); }
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+    // Appends a row holding the elements of 'row' (any range, including a row of this container)
+    template <typename Range>
+    constexpr void push_row(const Range& row);
+
+    // Appends a row holding the elements of the initializer list
+    constexpr void push_row(std::initializer_list<T> row) { push_row<std::initializer_list<T>>(row); }
+
+    // Appends an empty row
+    constexpr void push_empty_row() { offsets_.push_back(values_.size()); }
+
+    // Removes the last row
+    constexpr void pop_row();
+
+    // Appends 'value' to the last row. Throws std::out_of_range if there are no rows
+    constexpr void append(const T& value);
+
+    // Appends the elements of 'range' to the last row. Throws std::out_of_range if there are no rows
+    template <typename Range>
+    constexpr void append_range(const Range& range);
+
+    // Removes all rows
+    constexpr void clear() { values_.clear(); offsets_.clear(); offsets_.push_back(0); }
+
+    // Swaps the contents
+    constexpr void swap(jagged_vector& other) noexcept { values_.swap(other.values_); offsets_.swap(other.offsets_); }
+
+private:
+    // appends the elements of 'range' to values_; all or nothing
+    template <typename Range>
+    constexpr void append_values(const Range& range);
+
+private:
+    values_type values_;
+    offsets_type offsets_;
+};
+
+// +++++++++++++++++++ CLASS jagged_vector IMPLEMENTATION +++++++++++++++++++
+
+template<typename T, typename Alloc>
+template<typename RowAlloc, typename OuterAlloc>
+constexpr jagged_vector<T, Alloc>::jagged_vector(const vector<vector<T, RowAlloc>, OuterAlloc>& rows) {
+    size_type total = 0;
+    for (const auto& row : rows) {
+        total += row.size();
+    }
+    reserve(rows.size(), total);
+    offsets_.push_back(0);
+    for (const auto& row : rows) {
+        push_row(row);
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr jagged_vector<T, Alloc>::jagged_vector(std::initializer_list<std::initializer_list<T>> rows) {
+    offsets_.push_back(0);
+    for (const auto& row : rows) {
+        push_row(row);
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr jagged_vector<T, Alloc>::jagged_vector(jagged_vector&& other) {
+    // allocated before 'other' is touched, then handed to it: offsets_ always starts with 0
+    offsets_.push_back(0);
+    values_ = std::move(other.values_);
+    offsets_.swap(other.offsets_);
+}
+
+template<typename T, typename Alloc>
+constexpr jagged_vector<T, Alloc>& jagged_vector<T, Alloc>::operator=(jagged_vector&& other) noexcept(std::is_nothrow_move_assignable_v<values_type>) {
+    if (this == &other) return *this;
+    values_ = std::move(other.values_);
+    offsets_.swap(other.offsets_);
+    // our old offsets hold at least the leading 0, so this stays within their capacity
+    other.offsets_.clear();
+    other.offsets_.push_back(0);
+    return *this;
+}
+
+template<typename T, typename Alloc>
+constexpr jagged_vector<T, Alloc>::row_type jagged_vector<T, Alloc>::at(size_type row) {
+    if (row >= size()) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return (*this)[row];
+}
+
+template<typename T, typename Alloc>
+constexpr jagged_vector<T, Alloc>::const_row_type jagged_vector<T, Alloc>::at(size_type row) const {
+    if (row >= size()) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return (*this)[row];
+}
+
+template<typename T, typename Alloc>
+constexpr void jagged_vector<T, Alloc>::reserve(size_type rows, size_type values) {
+    values_.reserve(values);
+    offsets_.reserve(rows + 1);
+}
+
+template<typename T, typename Alloc>
+template<typename Range>
+constexpr void jagged_vector<T, Alloc>::push_row(const Range& row) {
+    const size_type old_size = values_.size();
+    append_values(row);
+    VECTOR_TRY {
+        offsets_.push_back(values_.size());
+    }
+    VECTOR_CATCH(...) {
+        values_.erase(values_.begin() + old_size, values_.end());
+        VECTOR_RETHROW;
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr void jagged_vector<T, Alloc>::pop_row() {
+    if (empty()) {
+        return;
+    }
+    offsets_.pop_back();
+    values_.erase(values_.begin() + offsets_[size()], values_.end());
+}
+
+template<typename T, typename Alloc>
+constexpr void jagged_vector<T, Alloc>::append(const T& value) {
+    if (empty()) {
+        VECTOR_THROW(std::out_of_range("no row to append to"));
+    }
+    values_.push_back(value);
+    offsets_[size()] = values_.size();
+}
+
+template<typename T, typename Alloc>
+template<typename Range>
+constexpr void jagged_vector<T, Alloc>::append_range(const Range& range) {
+    if (empty()) {
+        VECTOR_THROW(std::out_of_range("no row to append to"));
+    }
+    append_values(range);
+    offsets_[size()] = values_.size();
+}
+
+template<typename T, typename Alloc>
+template<typename Range>
+constexpr void jagged_vector<T, Alloc>::append_values(const Range& range) {
+    // only a range of T can be one of our own rows
+    if constexpr (std::is_same_v<std::remove_cv_t<std::ranges::range_value_t<Range>>, T> && requires { range.data(); range.size(); }) {
+        const T* first = range.data();
+        const T* buffer = values_.data();
+        bool inside = false;
+        if (std::is_constant_evaluated()) {
+            // unrelated pointers cannot be ordered during constant evaluation
+            for (size_type i = 0; i < values_.size() && !inside; ++i) {
+                inside = buffer + i == first;
+            }
+        }
+        else {
+            inside = std::less_equal<const T*>()(buffer, first) && std::less<const T*>()(first, buffer + values_.size());
+        }
+        if (range.size() != 0 && inside) {
+            // one of our own rows: growing values_ would invalidate it, so copy it out first
+            values_type copy(first, first + range.size());
+            append_values(copy);
+            return;
+        }
+    }
+    const size_type old_size = values_.size();
+    VECTOR_TRY {
+        if constexpr (std::ranges::sized_range<const Range> && std::ranges::forward_range<const Range> && std::ranges::common_range<const Range>) {
+            // the size is known up front: one reservation for the whole row
+            values_.insert(values_.end(), std::ranges::begin(range), std::ranges::end(range));
+        }
+        else {
+            for (const auto& value : range) {
+                values_.push_back(value);
+            }
+        }
+    }
+    VECTOR_CATCH(...) {
+        values_.erase(values_.begin() + old_size, values_.end());
+        VECTOR_RETHROW;
+    }
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename T, typename Alloc>
+[[nodiscard]]
+constexpr bool operator==(const jagged_vector<T, Alloc>& lhs, const jagged_vector<T, Alloc>& rhs) {
+    return lhs.offsets() == rhs.offsets() && lhs.values() == rhs.values();
+}
+
+template<typename T, typename Alloc>
+[[nodiscard]]
+constexpr bool operator!=(const jagged_vector<T, Alloc>& lhs, const jagged_vector<T, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,113 @@
+/*
+ * malloc_allocator<T> - allocator on top of malloc/free that reports the usable size of each block.
+ *
+ * malloc serves requests from size classes, so a block is often larger than what was asked for.
+ * allocate_at_least returns that real size (malloc_usable_size / malloc_size), and vector records
+ * it as capacity instead of reallocating again when it could have grown in place.
+ * std::allocator goes through operator new, which may be replaced and is not guaranteed to sit
+ * on malloc, so asking malloc about its blocks is only done for this allocator.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#if defined(__GLIBC__) || defined(__linux__)
+#include <malloc.h>
+#define MALLOC_ALLOCATOR_USABLE_SIZE(p) ::malloc_usable_size(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define MALLOC_ALLOCATOR_USABLE_SIZE(p) ::malloc_size(p)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define MALLOC_ALLOCATOR_USABLE_SIZE(p) ::_msize(p)
+#endif
+
+#include "vector.h"
+
+template <typename T>
+class malloc_allocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not provide over-aligned storage, use aligned_allocator");
+
+public:
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using is_always_equal = std::true_type;
+
+#if defined(__cpp_lib_allocate_at_least)
+    using allocation_result = std::allocation_result<T*, std::size_t>;
+#else
+    // the pointer and the number of elements it has room for (std::allocation_result before C++23)
+    struct allocation_result {
+        T* ptr;
+        std::size_t count;
+    };
+#endif
+
+    constexpr malloc_allocator() noexcept = default;
+
+    template <typename U>
+    constexpr malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+    [[nodiscard]] constexpr T* allocate(std::size_t n) {
+        if (std::is_constant_evaluated()) {
+            return std::allocator<T>().allocate(n);
+        }
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+#if VECTOR_EXCEPTIONS
+            throw std::bad_array_new_length();
+#else
+            return nullptr;
+#endif
+        }
+        // malloc(0) may return nullptr, which would look like a failure
+        void* p = std::malloc(n > 0 ? n * sizeof(T) : 1);
+#if VECTOR_EXCEPTIONS
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+#endif
+        // without exceptions a failure is returned as nullptr, which vector turns into vector_errc::bad_alloc
+        return static_cast<T*>(p);
+    }
+
+    // Allocates room for at least 'n' elements and returns how many actually fit in the block
+    [[nodiscard]] constexpr allocation_result allocate_at_least(std::size_t n) {
+        T* p = allocate(n);
+        if (p == nullptr) {
+            return allocation_result{p, 0};
+        }
+        std::size_t count = n;
+#ifdef MALLOC_ALLOCATOR_USABLE_SIZE
+        if (!std::is_constant_evaluated()) {
+            count = MALLOC_ALLOCATOR_USABLE_SIZE(p) / sizeof(T);
+        }
+#endif
+        return allocation_result{p, count};
+    }
+
+    constexpr void deallocate(T* p, std::size_t n) noexcept {
+        if (std::is_constant_evaluated()) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        std::free(p);
+    }
+
+    template <typename U>
+    constexpr bool operator==(const malloc_allocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    constexpr bool operator!=(const malloc_allocator<U>&) const noexcept { return false; }
+};
+
+// A vector that grows into the slack malloc leaves at the end of its size-class blocks
+template <typename T>
+using malloc_vector = vector<T, malloc_allocator<T>>;
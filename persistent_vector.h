@@ -0,0 +1,790 @@
+/*
+ * persistent_vector<T> - an immutable vector with structural sharing.
+ *
+ * A relaxed radix balanced (RRB) tree of 32-way nodes plus a tail leaf. Every "modifying"
+ * operation returns a new version that shares all untouched nodes with the old one, so
+ * push_back, pop_back and update copy O(log32 n) nodes and concat links two trees in
+ * O(log32 n). Nodes built by concat carry a cumulative size table ("relaxed" nodes),
+ * balanced nodes are indexed by radix only.
+ *
+ * A transient is a mutable builder: it edits nodes it owns exclusively in place and
+ * copies shared ones, so a batch of k edits costs O(k) instead of O(k log n) copies.
+ * Ownership is explicit: every node records the edit token of the object that created it,
+ * and tokens are never shared between objects, so a node reachable from another version is
+ * never modified. Versions may be read and copied from any number of threads concurrently;
+ * a single transient must only be used by one thread at a time.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+template <typename T>
+class persistent_vector {
+    static constexpr int bits = 5;
+    static constexpr std::size_t width = std::size_t(1) << bits;
+
+    struct node;
+    using node_ptr = std::shared_ptr<node>;
+
+    // one node type for leaves and inner nodes; a node never changes its kind
+    struct node {
+        vector<T> values;               // leaf: up to 'width' elements
+        vector<node_ptr> children;      // inner node: up to 'width' subtrees
+        vector<std::size_t> sizes;      // inner node: cumulative subtree sizes, empty if balanced
+        std::uint64_t edit = 0;         // token of the only object allowed to modify the node in place
+    };
+
+    // identity of an object that may edit nodes in place; a copy always gets a new one
+    struct edit_token {
+        std::uint64_t id = next();
+
+        edit_token() = default;
+        edit_token(const edit_token&) noexcept : id(next()) {}
+        edit_token& operator=(const edit_token&) noexcept { id = next(); return *this; }
+        // a move hands the nodes over together with the token; the source starts owning nothing
+        edit_token(edit_token&& other) noexcept : id(std::exchange(other.id, next())) {}
+        edit_token& operator=(edit_token&& other) noexcept { id = std::exchange(other.id, next()); return *this; }
+
+        static std::uint64_t next() noexcept {
+            static std::atomic<std::uint64_t> counter{ 0 };
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+    };
+
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using const_reference = const value_type&;
+
+    class transient;
+
+    // CLASS const_iterator. Caches the current leaf, so a full scan costs O(n)
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return leaf_[index_ - leaf_first_]; }
+        pointer operator->() const { return leaf_ + (index_ - leaf_first_); }
+
+        const_iterator& operator++() {
+            ++index_;
+            if (index_ >= leaf_last_ && index_ < owner_->size_) {
+                load_leaf();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        friend class persistent_vector;
+
+        const_iterator(const persistent_vector* owner, size_type index) : owner_(owner), index_(index) {
+            if (index_ < owner_->size_) {
+                load_leaf();
+            }
+        }
+
+        void load_leaf() {
+            const node* leaf = owner_->leaf_for(index_, leaf_first_);
+            leaf_ = &leaf->values[0];
+            leaf_last_ = leaf_first_ + leaf->values.size();
+        }
+
+        const persistent_vector* owner_ = nullptr;
+        size_type index_ = 0;
+        const T* leaf_ = nullptr;
+        size_type leaf_first_ = 0;
+        size_type leaf_last_ = 0;
+    };
+
+    using iterator = const_iterator;
+
+    //  ITERATORS
+
+    // returns an iterator that points to the first element
+    [[nodiscard]] const_iterator begin() const { return const_iterator(this, 0); }
+
+    // returns an iterator that points one past the last element
+    [[nodiscard]] const_iterator end() const { return const_iterator(this, size_); }
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+    // Default constructor. Constructs an empty vector
+    persistent_vector() = default;
+
+    // Constructs the vector with the contents of the initializer list
+    persistent_vector(std::initializer_list<T>);
+
+    // Constructs the vector with the contents of the range [first, last]
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    persistent_vector(InputIt first, InputIt last);
+
+    // Constructs the vector with the contents of 'other'
+    template <typename Alloc>
+    explicit persistent_vector(const vector<T, Alloc>& other);
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+    // Returns a read - only reference to the element at 'index' in O(log32 n). No bounds checking is performed.
+    const_reference operator[](size_type index) const;
+
+    // Returns a read - only reference to the element at 'index', with bounds checking.
+    const_reference at(size_type index) const;
+
+    // Returns a read - only reference to the first element
+    const_reference front() const;
+
+    // Returns a read - only reference to the last element
+    const_reference back() const;
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of elements
+    size_type size() const noexcept { return size_; }
+
+    // Checks if the vector has no elements
+    bool empty() const noexcept { return size_ == 0; }
+
+    // +++++++++++++++++++ NEW VERSIONS +++++++++++++++++++
+
+    // Returns a new version with 'value' appended
+    [[nodiscard]] persistent_vector push_back(const T& value) const;
+
+    // Returns a new version with 'value' appended using move semantics
+    [[nodiscard]] persistent_vector push_back(T&& value) const;
+
+    // Returns a new version without the last element
+    [[nodiscard]] persistent_vector pop_back() const;
+
+    // Returns a new version with the element at 'index' replaced by 'value'. Throws std::out_of_range
+    [[nodiscard]] persistent_vector update(size_type index, const T& value) const;
+
+    // Returns a new version with the element at 'index' replaced by 'value' using move semantics
+    [[nodiscard]] persistent_vector update(size_type index, T&& value) const;
+
+    // Returns the concatenation of this vector and 'other', sharing the nodes of both
+    [[nodiscard]] persistent_vector concat(const persistent_vector& other) const;
+
+    // +++++++++++++++++++ CONVERSIONS +++++++++++++++++++
+
+    // Returns a mutable builder initialized with this version
+    [[nodiscard]] transient as_transient() const;
+
+    // Copies the elements into a contiguous vector
+    template <typename Alloc = std::allocator<T>>
+    [[nodiscard]] vector<T, Alloc> to_vector() const;
+
+private:
+    // returns the leaf containing 'index' and the index of its first element
+    const node* leaf_for(size_type index, size_type& leaf_first) const;
+
+    // number of elements stored in the tree (without the tail)
+    size_type tree_size() const noexcept { return size_ - (tail_ ? tail_->values.size() : 0); }
+
+    // in-place edits shared by the persistent operations and transient
+    template <typename U>
+    void push_back_in_place(U&& value);
+    void pop_back_in_place();
+    template <typename U>
+    void update_in_place(size_type index, U&& value);
+
+    // appends a leaf holding 'leaf_size' elements to the tree, growing the root if it is full
+    void push_tail_leaf(const node_ptr& leaf, size_type leaf_size);
+
+    // tree helpers
+    node_ptr new_node() const;
+    node_ptr& editable(node_ptr& slot) const;
+    static size_type size_of(const node* n, int shift);
+    static size_type child_size(const node* n, size_type child, int shift);
+    static size_type find_child(const node* n, size_type& index, int shift);
+    static bool has_room(const node* n, int shift);
+    static void relax(node& n, int shift);
+    static void normalize(node& n, int shift);
+    node_ptr new_path(int shift, const node_ptr& leaf) const;
+    bool push_leaf(node_ptr& slot, int shift, const node_ptr& leaf, size_type leaf_size) const;
+    node_ptr pop_leaf(node_ptr& slot, int shift) const;
+    node_ptr make_inner(const node_ptr* first, const node_ptr* last, int shift) const;
+    int link_subtrees(const node_ptr& left, const node_ptr& right, int shift, node_ptr (&out)[2]) const;
+
+private:
+    node_ptr root_;         // inner node at height 'shift_', null if all elements are in the tail
+    node_ptr tail_;         // leaf with the last 1..32 elements, null if empty
+    int shift_ = bits;
+    size_type size_ = 0;
+    edit_token edit_;       // nodes carrying this token belong to this object alone
+};
+
+// CLASS persistent_vector::transient. Not thread safe; the versions it was created from are never modified
+
+template <typename T>
+class persistent_vector<T>::transient {
+public:
+    using size_type = std::size_t;
+
+    // Constructs an empty builder
+    transient() = default;
+
+    // A copy would share the nodes this builder edits in place, so builders only move
+    transient(const transient&) = delete;
+    transient& operator=(const transient&) = delete;
+
+    // Takes over the nodes of 'other' together with the right to edit them; 'other' is left empty
+    transient(transient&& other) noexcept : data_(std::exchange(other.data_, persistent_vector())) {}
+
+    transient& operator=(transient&& other) noexcept {
+        data_ = std::exchange(other.data_, persistent_vector());
+        return *this;
+    }
+
+    // Appends 'value'
+    void push_back(const T& value) { data_.push_back_in_place(value); }
+
+    // Appends 'value' using move semantics
+    void push_back(T&& value) { data_.push_back_in_place(std::move(value)); }
+
+    // Removes the last element
+    void pop_back() { data_.pop_back_in_place(); }
+
+    // Replaces the element at 'index' with 'value'. Throws std::out_of_range
+    void update(size_type index, const T& value) { data_.update_in_place(index, value); }
+
+    // Replaces the element at 'index' with 'value' using move semantics. Throws std::out_of_range
+    void update(size_type index, T&& value) { data_.update_in_place(index, std::move(value)); }
+
+    // Returns a read - only reference to the element at 'index'
+    const T& operator[](size_type index) const { return data_[index]; }
+
+    // Returns the number of elements
+    size_type size() const noexcept { return data_.size(); }
+
+    // Returns an immutable version of the current contents. The builder stays usable, but gives up
+    // ownership of its nodes: they are shared with the result now and get copied before its next edit
+    persistent_vector persistent() {
+        persistent_vector result(data_);
+        data_.edit_ = edit_token();
+        return result;
+    }
+
+private:
+    friend class persistent_vector;
+
+    explicit transient(const persistent_vector& data) : data_(data) {}
+
+    persistent_vector data_;
+};
+
+// +++++++++++++++++++ CLASS persistent_vector IMPLEMENTATION +++++++++++++++++++
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+template<typename T>
+inline persistent_vector<T>::persistent_vector(std::initializer_list<T> init_list) {
+    for (const T& value : init_list) {
+        push_back_in_place(value);
+    }
+}
+
+template<typename T>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+inline persistent_vector<T>::persistent_vector(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        push_back_in_place(*first);
+    }
+}
+
+template<typename T>
+template<typename Alloc>
+inline persistent_vector<T>::persistent_vector(const vector<T, Alloc>& other) {
+    for (size_type i = 0; i < other.size(); ++i) {
+        push_back_in_place(other[i]);
+    }
+}
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+template<typename T>
+inline const T& persistent_vector<T>::operator[](size_type index) const {
+    size_type leaf_first = 0;
+    const node* leaf = leaf_for(index, leaf_first);
+    return leaf->values[index - leaf_first];
+}
+
+template<typename T>
+inline const T& persistent_vector<T>::at(size_type index) const {
+    if (index >= size_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return (*this)[index];
+}
+
+template<typename T>
+inline const T& persistent_vector<T>::front() const {
+    return (*this)[0];
+}
+
+template<typename T>
+inline const T& persistent_vector<T>::back() const {
+    return tail_->values.back();
+}
+
+    // +++++++++++++++++++ NEW VERSIONS +++++++++++++++++++
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::push_back(const T& value) const {
+    persistent_vector result(*this);
+    result.push_back_in_place(value);
+    return result;
+}
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::push_back(T&& value) const {
+    persistent_vector result(*this);
+    result.push_back_in_place(std::move(value));
+    return result;
+}
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::pop_back() const {
+    persistent_vector result(*this);
+    result.pop_back_in_place();
+    return result;
+}
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::update(size_type index, const T& value) const {
+    persistent_vector result(*this);
+    result.update_in_place(index, value);
+    return result;
+}
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::update(size_type index, T&& value) const {
+    persistent_vector result(*this);
+    result.update_in_place(index, std::move(value));
+    return result;
+}
+
+template<typename T>
+inline persistent_vector<T> persistent_vector<T>::concat(const persistent_vector& other) const {
+    if (other.empty()) return *this;
+    if (empty()) return other;
+
+    persistent_vector result(*this);
+    if (!other.root_) {
+        // at most one leaf on the right, appending is cheaper than linking
+        for (const T& value : other.tail_->values) {
+            result.push_back_in_place(value);
+        }
+        return result;
+    }
+
+    // flush our tail into the tree, the right tail becomes the new tail
+    result.push_tail_leaf(result.tail_, result.tail_->values.size());
+    result.tail_ = other.tail_;
+
+    node_ptr left = result.root_;
+    node_ptr right = other.root_;
+    int left_shift = result.shift_;
+    int right_shift = other.shift_;
+
+    // bring both trees to the same height with single-child parents, linking absorbs them again
+    for (; left_shift < right_shift; left_shift += bits) {
+        node_ptr parent = result.new_node();
+        parent->children.push_back(left);
+        left = parent;
+    }
+    for (; right_shift < left_shift; right_shift += bits) {
+        node_ptr parent = result.new_node();
+        parent->children.push_back(right);
+        right = parent;
+    }
+
+    node_ptr linked[2];
+    const int count = result.link_subtrees(left, right, left_shift, linked);
+    if (count == 1) {
+        result.root_ = linked[0];
+        result.shift_ = left_shift;
+    }
+    else {
+        result.root_ = result.make_inner(linked, linked + 2, left_shift + bits);
+        result.shift_ = left_shift + bits;
+    }
+    while (result.shift_ > bits && result.root_->children.size() == 1) {
+        node_ptr child = result.root_->children[0];
+        result.root_ = child;
+        result.shift_ -= bits;
+    }
+    result.size_ = size_ + other.size_;
+    return result;
+}
+
+    // +++++++++++++++++++ CONVERSIONS +++++++++++++++++++
+
+template<typename T>
+inline persistent_vector<T>::transient persistent_vector<T>::as_transient() const {
+    return transient(*this);
+}
+
+template<typename T>
+template<typename Alloc>
+inline vector<T, Alloc> persistent_vector<T>::to_vector() const {
+    vector<T, Alloc> result;
+    result.reserve(size_);
+    for (const T& value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+    // OTHER (private methods - helpers)
+
+template<typename T>
+inline const persistent_vector<T>::node* persistent_vector<T>::leaf_for(size_type index, size_type& leaf_first) const {
+    const size_type tail_first = tree_size();
+    if (index >= tail_first) {
+        leaf_first = tail_first;
+        return tail_.get();
+    }
+    size_type rest = index;
+    const node* n = root_.get();
+    for (int shift = shift_; shift > 0; shift -= bits) {
+        n = n->children[find_child(n, rest, shift)].get();
+    }
+    leaf_first = index - rest;
+    return n;
+}
+
+template<typename T>
+template<typename U>
+inline void persistent_vector<T>::push_back_in_place(U&& value) {
+    if (tail_ && tail_->values.size() == width) {
+        push_tail_leaf(tail_, width);
+        tail_.reset();
+    }
+    if (!tail_) {
+        tail_ = new_node();
+        tail_->values.reserve(width);
+    }
+    editable(tail_)->values.push_back(std::forward<U>(value));
+    ++size_;
+}
+
+template<typename T>
+inline void persistent_vector<T>::pop_back_in_place() {
+    if (size_ == 0) return;
+    editable(tail_)->values.pop_back();
+    --size_;
+    if (!tail_->values.empty()) return;
+
+    if (!root_) {
+        tail_.reset();
+        return;
+    }
+    tail_ = pop_leaf(root_, shift_);
+    if (root_->children.empty()) {
+        root_.reset();
+        shift_ = bits;
+        return;
+    }
+    while (shift_ > bits && root_->children.size() == 1) {
+        node_ptr child = root_->children[0];
+        root_ = child;
+        shift_ -= bits;
+    }
+}
+
+template<typename T>
+template<typename U>
+inline void persistent_vector<T>::update_in_place(size_type index, U&& value) {
+    if (index >= size_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    const size_type tail_first = tree_size();
+    if (index >= tail_first) {
+        editable(tail_)->values[index - tail_first] = std::forward<U>(value);
+        return;
+    }
+    node_ptr* slot = &root_;
+    for (int shift = shift_; shift > 0; shift -= bits) {
+        node* n = editable(*slot).get();
+        slot = &n->children[find_child(n, index, shift)];
+    }
+    editable(*slot)->values[index] = std::forward<U>(value);
+}
+
+template<typename T>
+inline void persistent_vector<T>::push_tail_leaf(const node_ptr& leaf, size_type leaf_size) {
+    if (!root_) {
+        root_ = new_node();
+        root_->children.push_back(leaf);
+        shift_ = bits;
+        return;
+    }
+    if (push_leaf(root_, shift_, leaf, leaf_size)) return;
+
+    // the root is full: grow the tree by one level
+    const size_type old_size = size_of(root_.get(), shift_);
+    node_ptr root = new_node();
+    root->children.push_back(root_);
+    root->children.push_back(new_path(shift_, leaf));
+    if (old_size != (size_type(1) << (shift_ + bits))) {
+        root->sizes.push_back(old_size);
+        root->sizes.push_back(old_size + leaf_size);
+    }
+    root_ = root;
+    shift_ += bits;
+}
+
+// creates an empty node owned by this object
+template<typename T>
+inline persistent_vector<T>::node_ptr persistent_vector<T>::new_node() const {
+    node_ptr result = std::make_shared<node>();
+    result->edit = edit_.id;
+    return result;
+}
+
+// copy-on-write: clones the node unless this object created it. Reference counts are not consulted,
+// another thread may be copying a version that shares the node at any moment
+template<typename T>
+inline persistent_vector<T>::node_ptr& persistent_vector<T>::editable(node_ptr& slot) const {
+    if (slot->edit != edit_.id) {
+        slot = std::make_shared<node>(*slot);
+        slot->edit = edit_.id;
+    }
+    return slot;
+}
+
+template<typename T>
+inline std::size_t persistent_vector<T>::size_of(const node* n, int shift) {
+    if (shift == 0) return n->values.size();
+    if (!n->sizes.empty()) return n->sizes.back();
+    return ((n->children.size() - 1) << shift) + size_of(n->children.back().get(), shift - bits);
+}
+
+template<typename T>
+inline std::size_t persistent_vector<T>::child_size(const node* n, size_type child, int shift) {
+    if (!n->sizes.empty()) {
+        return n->sizes[child] - (child > 0 ? n->sizes[child - 1] : 0);
+    }
+    if (child + 1 < n->children.size()) {
+        return size_type(1) << shift;
+    }
+    return size_of(n->children[child].get(), shift - bits);
+}
+
+// returns the child of 'n' that holds 'index' and makes 'index' relative to that child
+template<typename T>
+inline std::size_t persistent_vector<T>::find_child(const node* n, size_type& index, int shift) {
+    size_type child = index >> shift;   // exact for balanced nodes, a lower bound for relaxed ones
+    if (n->sizes.empty()) {
+        index -= child << shift;
+        return child;
+    }
+    while (n->sizes[child] <= index) {
+        ++child;
+    }
+    if (child > 0) {
+        index -= n->sizes[child - 1];
+    }
+    return child;
+}
+
+template<typename T>
+inline bool persistent_vector<T>::has_room(const node* n, int shift) {
+    if (shift == 0) return false;   // leaves are only ever added whole
+    return n->children.size() < width || has_room(n->children.back().get(), shift - bits);
+}
+
+// turns a balanced node into a relaxed one
+template<typename T>
+inline void persistent_vector<T>::relax(node& n, int shift) {
+    if (!n.sizes.empty()) return;
+    // child_size reads the size table once it is not empty, so it is built aside and installed whole
+    vector<size_type> sizes;
+    sizes.reserve(n.children.size());
+    size_type total = 0;
+    for (size_type i = 0; i < n.children.size(); ++i) {
+        total += child_size(&n, i, shift);
+        sizes.push_back(total);
+    }
+    n.sizes = std::move(sizes);
+}
+
+// drops the size table of a relaxed node whose children are all full except the last one
+template<typename T>
+inline void persistent_vector<T>::normalize(node& n, int shift) {
+    if (n.sizes.empty()) return;
+    for (size_type i = 0; i + 1 < n.children.size(); ++i) {
+        if (n.sizes[i] != ((i + 1) << shift)) return;
+    }
+    n.sizes.clear();
+}
+
+template<typename T>
+inline persistent_vector<T>::node_ptr persistent_vector<T>::new_path(int shift, const node_ptr& leaf) const {
+    if (shift == 0) return leaf;
+    node_ptr parent = new_node();
+    parent->children.push_back(new_path(shift - bits, leaf));
+    return parent;
+}
+
+template<typename T>
+inline bool persistent_vector<T>::push_leaf(node_ptr& slot, int shift, const node_ptr& leaf, size_type leaf_size) const {
+    const node* n = slot.get();
+    if (shift > bits && !n->children.empty() && has_room(n->children.back().get(), shift - bits)) {
+        node* m = editable(slot).get();
+        push_leaf(m->children.back(), shift - bits, leaf, leaf_size);
+        if (!m->sizes.empty()) {
+            m->sizes.back() += leaf_size;
+        }
+        return true;
+    }
+    if (n->children.size() == width) return false;
+
+    node* m = editable(slot).get();
+    if (m->sizes.empty() && !m->children.empty()
+        && size_of(m->children.back().get(), shift - bits) != (size_type(1) << shift)) {
+        relax(*m, shift);   // the previous last child stops being last while not full
+    }
+    m->children.push_back(new_path(shift - bits, leaf));
+    if (!m->sizes.empty()) {
+        m->sizes.push_back(m->sizes.back() + leaf_size);
+    }
+    return true;
+}
+
+template<typename T>
+inline persistent_vector<T>::node_ptr persistent_vector<T>::pop_leaf(node_ptr& slot, int shift) const {
+    node* m = editable(slot).get();
+    node_ptr leaf;
+    if (shift == bits) {
+        leaf = m->children.back();
+        m->children.pop_back();
+        if (!m->sizes.empty()) m->sizes.pop_back();
+        return leaf;
+    }
+    leaf = pop_leaf(m->children.back(), shift - bits);
+    if (m->children.back()->children.empty()) {
+        m->children.pop_back();
+        if (!m->sizes.empty()) m->sizes.pop_back();
+    }
+    else if (!m->sizes.empty()) {
+        m->sizes.back() -= leaf->values.size();
+    }
+    return leaf;
+}
+
+// builds an inner node over the subtrees [first, last], relaxed only if it has to be
+template<typename T>
+inline persistent_vector<T>::node_ptr persistent_vector<T>::make_inner(const node_ptr* first, const node_ptr* last, int shift) const {
+    node_ptr result = new_node();
+    result->children.reserve(last - first);
+    result->sizes.reserve(last - first);
+    size_type total = 0;
+    for (; first != last; ++first) {
+        total += size_of(first->get(), shift - bits);
+        result->children.push_back(*first);
+        result->sizes.push_back(total);
+    }
+    normalize(*result, shift);
+    return result;
+}
+
+/* Links two subtrees of the same height along their seam: the rightmost path of 'left' is merged
+* with the leftmost path of 'right' level by level, so only O(log32 n) nodes are created.
+* Returns the number of resulting siblings (1 or 2) written to 'out' */
+template<typename T>
+inline int persistent_vector<T>::link_subtrees(const node_ptr& left, const node_ptr& right, int shift, node_ptr (&out)[2]) const {
+    if (shift == 0) {
+        if (left->values.size() + right->values.size() > width) {
+            out[0] = left;
+            out[1] = right;
+            return 2;
+        }
+        node_ptr leaf = std::make_shared<node>(*left);
+        leaf->edit = edit_.id;
+        for (const T& value : right->values) {
+            leaf->values.push_back(value);
+        }
+        out[0] = leaf;
+        return 1;
+    }
+
+    node_ptr middle[2];
+    const int middle_count = link_subtrees(left->children.back(), right->children[0], shift - bits, middle);
+
+    vector<node_ptr> all;
+    all.reserve(left->children.size() + right->children.size());
+    for (size_type i = 0; i + 1 < left->children.size(); ++i) {
+        all.push_back(left->children[i]);
+    }
+    for (int i = 0; i < middle_count; ++i) {
+        all.push_back(middle[i]);
+    }
+    for (size_type i = 1; i < right->children.size(); ++i) {
+        all.push_back(right->children[i]);
+    }
+
+    const node_ptr* first = &all[0];
+    if (all.size() <= width) {
+        out[0] = make_inner(first, first + all.size(), shift);
+        return 1;
+    }
+    out[0] = make_inner(first, first + width, shift);
+    out[1] = make_inner(first + width, first + all.size(), shift);
+    return 2;
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename T>
+[[nodiscard]]
+inline bool operator==(const persistent_vector<T>& lhs, const persistent_vector<T>& rhs) {
+    if (lhs.size() != rhs.size()) return false;
+    auto it = rhs.begin();
+    for (const T& value : lhs) {
+        if (!(value == *it)) return false;
+        ++it;
+    }
+    return true;
+}
+
+// based on operator==
+template<typename T>
+[[nodiscard]]
+inline bool operator!=(const persistent_vector<T>& lhs, const persistent_vector<T>& rhs) {
+    return !(lhs == rhs);
+}
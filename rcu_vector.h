@@ -0,0 +1,412 @@
+/*
+ * rcu_vector<T> - a vector with one writer and lock-free readers.
+ *
+ * Readers take a read_guard, which pins the current buffer and the number of elements
+ * published at that moment; they never block and never see a partially constructed
+ * element. The single writer appends in place while capacity lasts and otherwise copies
+ * into a new buffer, publishes it and retires the old one. Retired buffers are freed
+ * with epoch based reclamation once no reader that could still see them is active.
+ * Readers register in one of several cache-line sized counter stripes picked per thread,
+ * so concurrent readers on different cores do not contend on a shared counter.
+ *
+ * Writer functions must not be called concurrently with each other. Only the writer frees
+ * retired buffers, on its next modification: after the last write of a burst, call reclaim()
+ * (or synchronize()) to release them without waiting for another write.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "vector_exceptions.h"
+
+template <typename T, typename Alloc = std::allocator<T>>
+class rcu_vector {
+    struct buffer {
+        std::atomic<std::size_t> size{ 0 };    // published elements, only grows
+        std::size_t capacity = 0;
+        T* data = nullptr;
+        buffer* next_retired = nullptr;
+        std::uint64_t retire_epoch = 0;
+    };
+
+    // active readers per epoch parity; each stripe has its own cache line
+    struct alignas(64) reader_stripe {
+        std::atomic<std::size_t> count[2] = {};
+    };
+
+    static constexpr std::size_t reader_stripes = 16;
+
+    // the stripe of the calling thread, assigned round robin on first use
+    static std::size_t reader_stripe_index() noexcept {
+        static std::atomic<std::size_t> next{ 0 };
+        thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % reader_stripes;
+        return index;
+    }
+
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = T;
+
+    using allocator_type = Alloc;
+
+    using size_type = std::size_t;
+
+    using const_reference = const value_type&;
+
+    using const_iterator = const T*;
+
+    // CLASS read_guard. A consistent snapshot; the elements stay valid until the guard is destroyed
+
+    class read_guard {
+    public:
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+
+        ~read_guard() { owner_->readers_[stripe_].count[parity_].fetch_sub(1, std::memory_order_release); }
+
+        [[nodiscard]] const_iterator begin() const noexcept { return data_; }
+        [[nodiscard]] const_iterator end() const noexcept { return data_ + size_; }
+        [[nodiscard]] const T* data() const noexcept { return data_; }
+        [[nodiscard]] size_type size() const noexcept { return size_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+        const_reference operator[](size_type index) const noexcept { return data_[index]; }
+
+    private:
+        friend class rcu_vector;
+
+        explicit read_guard(const rcu_vector& owner);
+
+        const rcu_vector* owner_;
+        std::size_t stripe_;
+        std::size_t parity_;
+        const T* data_;
+        size_type size_;
+    };
+
+    // +++++++++++++++++++ CONSTRUCTORS, DTOR +++++++++++++++++++
+
+    // Default constructor. Constructs an empty container
+    rcu_vector();
+
+    // Constructs an empty container with room for 'cap' elements
+    explicit rcu_vector(size_type cap);
+
+    rcu_vector(const rcu_vector&) = delete;
+    rcu_vector& operator=(const rcu_vector&) = delete;
+
+    // A Destructor. No read_guard may be alive
+    ~rcu_vector() noexcept;
+
+    // +++++++++++++++++++ READERS +++++++++++++++++++
+
+    // Pins the current contents. Wait-free: one increment and one decrement of this thread's reader stripe
+    [[nodiscard]] read_guard read() const { return read_guard(*this); }
+
+    // +++++++++++++++++++ WRITER +++++++++++++++++++
+
+    // Returns the number of elements, as seen by the writer
+    size_type size() const noexcept;
+
+    // Returns the capacity of the current buffer
+    size_type capacity() const noexcept;
+
+    // Makes room for 'newcap' elements, publishing a new buffer if needed
+    void reserve(size_type newcap);
+
+    // Appends a new element, publishing a bigger buffer if the current one is full
+    template <typename... Args>
+    void emplace_back(Args&&... args);
+
+    // Appends a copy of 'value'
+    void push_back(const T& value);
+
+    // Appends 'value' using move semantics
+    void push_back(T&& value);
+
+    /* Replaces the element at 'index'. Readers keep seeing the old value, so this publishes
+    * a copy of the whole buffer: O(n), batch replacements with replace_all where possible */
+    void update(size_type index, const T& value);
+
+    // Publishes a buffer where every element is replaced with 'fn(old element)'
+    template <typename Fn>
+    void replace_all(Fn&& fn);
+
+    // Publishes an empty buffer of the same capacity
+    void clear();
+
+    // Frees the retired buffers no reader can see anymore. Called by the modifiers automatically;
+    // call it after the last write of a burst, readers never free anything themselves
+    void reclaim();
+
+    // Blocks until every retired buffer is freed
+    void synchronize();
+
+private:
+    // the buffer header is allocated through 'Alloc' as well
+    using buffer_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<buffer>;
+    using buffer_traits = std::allocator_traits<buffer_alloc>;
+
+    buffer* make_buffer(size_type cap);
+    void free_buffer(buffer* b) noexcept;
+
+    // publishes 'fresh' as the current buffer and retires the previous one
+    void publish(buffer* fresh);
+
+    // builds a new buffer of 'cap' from the current elements; 'make(i, slot)' constructs element i
+    template <typename Make>
+    buffer* rebuild(size_type cap, size_type count, Make&& make);
+
+private:
+    std::atomic<buffer*> current_;
+    buffer* retired_ = nullptr;
+    mutable std::atomic<std::uint64_t> epoch_{ 0 };
+    mutable reader_stripe readers_[reader_stripes];
+    [[no_unique_address]] Alloc alloc_;
+    using alloc_traits = std::allocator_traits<Alloc>;
+};
+
+// +++++++++++++++++++ CLASS rcu_vector IMPLEMENTATION +++++++++++++++++++
+
+template<typename T, typename Alloc>
+inline rcu_vector<T, Alloc>::read_guard::read_guard(const rcu_vector& owner) : owner_(&owner) {
+    // registering before loading the buffer: a writer that sees zero readers in our epoch
+    // has already unpublished everything it is about to free
+    stripe_ = reader_stripe_index();
+    parity_ = owner.epoch_.load(std::memory_order_seq_cst) & 1;
+    owner.readers_[stripe_].count[parity_].fetch_add(1, std::memory_order_seq_cst);
+    buffer* current = owner.current_.load(std::memory_order_seq_cst);
+    data_ = current->data;
+    size_ = current->size.load(std::memory_order_acquire);
+}
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+template<typename T, typename Alloc>
+inline rcu_vector<T, Alloc>::rcu_vector() : current_(nullptr) {
+    current_.store(make_buffer(0), std::memory_order_relaxed);
+}
+
+template<typename T, typename Alloc>
+inline rcu_vector<T, Alloc>::rcu_vector(size_type cap) : current_(nullptr) {
+    current_.store(make_buffer(cap), std::memory_order_relaxed);
+}
+
+template<typename T, typename Alloc>
+inline rcu_vector<T, Alloc>::~rcu_vector() noexcept {
+    while (retired_ != nullptr) {
+        buffer* next = retired_->next_retired;
+        free_buffer(retired_);
+        retired_ = next;
+    }
+    free_buffer(current_.load(std::memory_order_relaxed));
+}
+
+    // +++++++++++++++++++ WRITER +++++++++++++++++++
+
+template<typename T, typename Alloc>
+inline std::size_t rcu_vector<T, Alloc>::size() const noexcept {
+    return current_.load(std::memory_order_relaxed)->size.load(std::memory_order_relaxed);
+}
+
+template<typename T, typename Alloc>
+inline std::size_t rcu_vector<T, Alloc>::capacity() const noexcept {
+    return current_.load(std::memory_order_relaxed)->capacity;
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::reserve(size_type newcap) {
+    buffer* current = current_.load(std::memory_order_relaxed);
+    if (newcap <= current->capacity) return;
+    const size_type count = current->size.load(std::memory_order_relaxed);
+    publish(rebuild(newcap, count, [&](size_type i, T* slot) {
+        alloc_traits::construct(alloc_, slot, current->data[i]);
+    }));
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+inline void rcu_vector<T, Alloc>::emplace_back(Args&&... args) {
+    buffer* current = current_.load(std::memory_order_relaxed);
+    const size_type count = current->size.load(std::memory_order_relaxed);
+    if (count < current->capacity) {
+        alloc_traits::construct(alloc_, current->data + count, std::forward<Args>(args)...);
+        current->size.store(count + 1, std::memory_order_release);
+        return;
+    }
+
+    // readers may still be reading the old elements, so they are copied, never moved
+    const size_type newcap = current->capacity > 0 ? current->capacity * 2 : 1;
+    buffer* fresh = make_buffer(newcap);
+    VECTOR_TRY {
+        alloc_traits::construct(alloc_, fresh->data + count, std::forward<Args>(args)...);
+    }
+    VECTOR_CATCH(...) {
+        free_buffer(fresh);
+        VECTOR_RETHROW;
+    }
+    size_type index = 0;
+    VECTOR_TRY {
+        for (; index < count; ++index) {
+            alloc_traits::construct(alloc_, fresh->data + index, current->data[index]);
+        }
+    }
+    VECTOR_CATCH(...) {
+        for (size_type i = 0; i < index; ++i) {
+            alloc_traits::destroy(alloc_, fresh->data + i);
+        }
+        alloc_traits::destroy(alloc_, fresh->data + count);
+        free_buffer(fresh);
+        VECTOR_RETHROW;
+    }
+    fresh->size.store(count + 1, std::memory_order_relaxed);
+    publish(fresh);
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::push_back(const T& value) {
+    emplace_back(value);
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::push_back(T&& value) {
+    emplace_back(std::move(value));
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::update(size_type index, const T& value) {
+    buffer* current = current_.load(std::memory_order_relaxed);
+    const size_type count = current->size.load(std::memory_order_relaxed);
+    if (index >= count) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    publish(rebuild(current->capacity, count, [&](size_type i, T* slot) {
+        if (i == index) {
+            alloc_traits::construct(alloc_, slot, value);
+        }
+        else {
+            alloc_traits::construct(alloc_, slot, current->data[i]);
+        }
+    }));
+}
+
+template<typename T, typename Alloc>
+template<typename Fn>
+inline void rcu_vector<T, Alloc>::replace_all(Fn&& fn) {
+    buffer* current = current_.load(std::memory_order_relaxed);
+    const size_type count = current->size.load(std::memory_order_relaxed);
+    publish(rebuild(current->capacity, count, [&](size_type i, T* slot) {
+        alloc_traits::construct(alloc_, slot, fn(static_cast<const T&>(current->data[i])));
+    }));
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::clear() {
+    publish(make_buffer(current_.load(std::memory_order_relaxed)->capacity));
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::reclaim() {
+    const std::uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+    // readers of the previous epoch share the counters of the next one. A reader that registers in a
+    // stripe after it was read here loads the current buffer after this point and cannot see a retired one
+    const std::size_t parity = (epoch + 1) & 1;
+    for (const reader_stripe& stripe : readers_) {
+        if (stripe.count[parity].load(std::memory_order_seq_cst) != 0) return;
+    }
+    epoch_.store(epoch + 1, std::memory_order_seq_cst);
+
+    // everything retired before 'epoch' began is invisible to all registered readers
+    buffer** link = &retired_;
+    while (*link != nullptr) {
+        buffer* b = *link;
+        if (b->retire_epoch < epoch) {
+            *link = b->next_retired;
+            free_buffer(b);
+        }
+        else {
+            link = &b->next_retired;
+        }
+    }
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::synchronize() {
+    while (retired_ != nullptr) {
+        reclaim();
+        if (retired_ != nullptr) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+    // OTHER (private methods - helpers)
+
+template<typename T, typename Alloc>
+inline rcu_vector<T, Alloc>::buffer* rcu_vector<T, Alloc>::make_buffer(size_type cap) {
+    buffer_alloc header_alloc(alloc_);
+    buffer* b = buffer_traits::allocate(header_alloc, 1);
+    buffer_traits::construct(header_alloc, b);
+    b->capacity = cap;
+    if (cap > 0) {
+        VECTOR_TRY {
+            b->data = alloc_traits::allocate(alloc_, cap);
+        }
+        VECTOR_CATCH(...) {
+            buffer_traits::destroy(header_alloc, b);
+            buffer_traits::deallocate(header_alloc, b, 1);
+            VECTOR_RETHROW;
+        }
+    }
+    return b;
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::free_buffer(buffer* b) noexcept {
+    const size_type count = b->size.load(std::memory_order_relaxed);
+    for (size_type i = 0; i < count; ++i) {
+        alloc_traits::destroy(alloc_, b->data + i);
+    }
+    if (b->data != nullptr) alloc_traits::deallocate(alloc_, b->data, b->capacity);
+    buffer_alloc header_alloc(alloc_);
+    buffer_traits::destroy(header_alloc, b);
+    buffer_traits::deallocate(header_alloc, b, 1);
+}
+
+template<typename T, typename Alloc>
+inline void rcu_vector<T, Alloc>::publish(buffer* fresh) {
+    buffer* old = current_.exchange(fresh, std::memory_order_seq_cst);
+    old->retire_epoch = epoch_.load(std::memory_order_seq_cst);
+    old->next_retired = retired_;
+    retired_ = old;
+    reclaim();
+}
+
+template<typename T, typename Alloc>
+template<typename Make>
+inline rcu_vector<T, Alloc>::buffer* rcu_vector<T, Alloc>::rebuild(size_type cap, size_type count, Make&& make) {
+    buffer* fresh = make_buffer(cap);
+    size_type index = 0;
+    VECTOR_TRY {
+        for (; index < count; ++index) {
+            make(index, fresh->data + index);
+        }
+    }
+    VECTOR_CATCH(...) {
+        for (size_type i = 0; i < index; ++i) {
+            alloc_traits::destroy(alloc_, fresh->data + i);
+        }
+        free_buffer(fresh);
+        VECTOR_RETHROW;
+    }
+    fresh->size.store(count, std::memory_order_relaxed);
+    return fresh;
+}
@@ -0,0 +1,141 @@
+/*
+ * static_search_index<T> - a read-only search structure built once from a sorted vector.
+ *
+ * The keys are re-laid out in Eytzinger (BFS) order: the root at index 1, the children of k at
+ * 2k and 2k + 1. The first levels of the implicit tree share a few cache lines, and since the
+ * descendants of k four levels down are contiguous, the search prefetches them while it is
+ * still comparing at k, overlapping the memory latency of the next levels with the current one.
+ * The descent is branchless and has no early exit.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+
+#include "vector.h"
+
+template <typename T, typename Compare = std::less<T>>
+class static_search_index {
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using key_compare = Compare;
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+    // Default constructor. Constructs an empty index
+    static_search_index() = default;
+
+    /* Builds the index from 'sorted', which must be ordered by 'comp'.
+    * Throws std::invalid_argument if it is not */
+    template <typename Alloc>
+    explicit static_search_index(const vector<T, Alloc>& sorted, const Compare& comp = Compare());
+
+    // +++++++++++++++++++ LOOKUP +++++++++++++++++++
+
+    // Returns the smallest key not ordered before 'key', nullptr if there is none
+    const T* lower_bound(const T& key) const noexcept;
+
+    // Returns the smallest key ordered after 'key', nullptr if there is none
+    const T* upper_bound(const T& key) const noexcept;
+
+    // Checks if a key equivalent to 'key' is present
+    bool contains(const T& key) const noexcept {
+        const T* found = lower_bound(key);
+        return found != nullptr && !comp_(key, *found);
+    }
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Returns the number of keys
+    size_type size() const noexcept { return size_; }
+
+    // Checks if the index has no keys
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    // fills the subtree rooted at 'k' with sorted[next, ...] in order, returns the next unused key
+    template <typename Alloc>
+    size_type build(const vector<T, Alloc>& sorted, size_type next, size_type k);
+
+    // requests the cache line holding the descendants of 'k' four levels down
+    void prefetch(size_type k) const noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        const size_type target = k * prefetch_stride;
+        __builtin_prefetch(layout_.data() + (target < size_ ? target : 0));
+#else
+        (void)k;
+#endif
+    }
+
+    // the descendants four levels down are 16 consecutive slots; small keys fetch more levels per line
+    static constexpr size_type prefetch_stride = std::max<size_type>(16, std::bit_floor(64 / sizeof(T)));
+
+private:
+    vector<T> layout_;     // layout_[0] is unused, the root is layout_[1]
+    size_type size_ = 0;
+    [[no_unique_address]] Compare comp_;
+};
+
+// +++++++++++++++++++ CLASS static_search_index IMPLEMENTATION +++++++++++++++++++
+
+template<typename T, typename Compare>
+template<typename Alloc>
+inline static_search_index<T, Compare>::static_search_index(const vector<T, Alloc>& sorted, const Compare& comp)
+    : size_(sorted.size()), comp_(comp) {
+
+    for (size_type i = 1; i < size_; ++i) {
+        if (comp_(sorted[i], sorted[i - 1])) {
+            VECTOR_THROW(std::invalid_argument("static_search_index requires sorted input"));
+        }
+    }
+    if (size_ == 0) return;
+    layout_.assign(size_ + 1, sorted[0]);
+    build(sorted, 0, 1);
+}
+
+template<typename T, typename Compare>
+template<typename Alloc>
+inline std::size_t static_search_index<T, Compare>::build(const vector<T, Alloc>& sorted, size_type next, size_type k) {
+    // in-order traversal of the implicit tree; the depth is log2(size)
+    if (k <= size_) {
+        next = build(sorted, next, 2 * k);
+        layout_[k] = sorted[next++];
+        next = build(sorted, next, 2 * k + 1);
+    }
+    return next;
+}
+
+template<typename T, typename Compare>
+inline const T* static_search_index<T, Compare>::lower_bound(const T& key) const noexcept {
+    const T* base = layout_.data();
+    size_type k = 1;
+    while (k <= size_) {
+        prefetch(k);
+        k = 2 * k + static_cast<size_type>(comp_(base[k], key));
+    }
+    // the answer is the last node where the search went left: drop the trailing right turns and that left turn
+    k >>= std::countr_one(k) + 1;
+    return k == 0 ? nullptr : base + k;
+}
+
+template<typename T, typename Compare>
+inline const T* static_search_index<T, Compare>::upper_bound(const T& key) const noexcept {
+    const T* base = layout_.data();
+    size_type k = 1;
+    while (k <= size_) {
+        prefetch(k);
+        k = 2 * k + static_cast<size_type>(!comp_(key, base[k]));
+    }
+    k >>= std::countr_one(k) + 1;
+    return k == 0 ? nullptr : base + k;
+}
@@ -0,0 +1,200 @@
+/*
+ * Differential test of persistent_vector against std::vector.
+ *
+ * Build: g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I. tests/persistent_vector_test.cpp -o persistent_vector_test
+ * Run:   ./persistent_vector_test [trials] [seed]
+ *
+ * Every trial grows a pool of versions with random push_back, pop_back, update, concat and
+ * transient batches, checks each new version element by element and through its iterators,
+ * and finally checks that none of the older versions changed. Exits non-zero on the first mismatch.
+ */
+
+#include "persistent_vector.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// a copied builder would share the nodes it edits in place
+static_assert(!std::is_copy_constructible_v<persistent_vector<int>::transient>);
+static_assert(!std::is_copy_assignable_v<persistent_vector<int>::transient>);
+
+using model = std::vector<int>;
+
+bool same(const persistent_vector<int>& p, const model& m) {
+    if (p.size() != m.size()) return false;
+    for (std::size_t i = 0; i < m.size(); ++i) {
+        if (p[i] != m[i]) return false;
+    }
+    std::size_t i = 0;
+    for (int value : p) {
+        if (i >= m.size() || value != m[i]) return false;
+        ++i;
+    }
+    return i == m.size();
+}
+
+bool fail(const char* what, unsigned trial, int step) {
+    std::printf("FAILED: %s (trial %u, step %d)\n", what, trial, step);
+    return false;
+}
+
+bool random_versions(unsigned trial, std::mt19937& rng) {
+    std::vector<std::pair<persistent_vector<int>, model>> pool;
+    pool.emplace_back();
+    for (int step = 0; step < 60; ++step) {
+        auto [p, m] = pool[rng() % pool.size()];
+        switch (rng() % 6) {
+        case 0:
+            for (unsigned n = rng() % 100; n > 0; --n) {
+                const int x = static_cast<int>(rng());
+                p = p.push_back(x);
+                m.push_back(x);
+            }
+            break;
+        case 1:
+            for (unsigned n = rng() % 50; n > 0 && !m.empty(); --n) {
+                p = p.pop_back();
+                m.pop_back();
+            }
+            break;
+        case 2:
+            if (!m.empty()) {
+                const std::size_t i = rng() % m.size();
+                const int x = static_cast<int>(rng());
+                p = p.update(i, x);
+                m[i] = x;
+            }
+            break;
+        case 3: {
+            const auto& [q, n] = pool[rng() % pool.size()];
+            p = p.concat(q);
+            m.insert(m.end(), n.begin(), n.end());
+            break;
+        }
+        case 4: {
+            auto builder = p.as_transient();
+            for (unsigned n = rng() % 70; n > 0; --n) {
+                const int x = static_cast<int>(rng());
+                builder.push_back(x);
+                m.push_back(x);
+            }
+            for (int n = 0; n < 10 && !m.empty(); ++n) {
+                const std::size_t i = rng() % m.size();
+                const int x = static_cast<int>(rng());
+                builder.update(i, x);
+                m[i] = x;
+            }
+            for (unsigned n = rng() % 40; n > 0 && !m.empty(); --n) {
+                builder.pop_back();
+                m.pop_back();
+            }
+            p = builder.persistent();
+            // the builder keeps working on its own copy of whatever it shares with 'p'
+            builder.push_back(-1);
+            if (!same(p, m)) return fail("transient edit after persistent() changed the result", trial, step);
+            break;
+        }
+        default:
+            for (unsigned n = rng() % 2000; n > 0; --n) {
+                const int x = static_cast<int>(rng());
+                p = p.push_back(x);
+                m.push_back(x);
+            }
+            break;
+        }
+        if (!same(p, m)) return fail("new version differs from the model", trial, step);
+        pool.emplace_back(std::move(p), std::move(m));
+    }
+    for (const auto& [p, m] : pool) {
+        if (!same(p, m)) return fail("an older version was modified", trial, -1);
+    }
+    return true;
+}
+
+// a concatenated tree is relaxed; pushes past its full leaves relax further nodes
+bool pushes_after_concat() {
+    persistent_vector<int> left, right;
+    model m;
+    for (int i = 0; i < 2013; ++i) {
+        left = left.push_back(i);
+        m.push_back(i);
+    }
+    for (int i = 0; i < 1500; ++i) {
+        right = right.push_back(-i);
+    }
+    persistent_vector<int> p = left.concat(right);
+    m.insert(m.end(), right.begin(), right.end());
+    for (int i = 0; i < 40000; ++i) {
+        p = p.push_back(i);
+        m.push_back(i);
+    }
+    return same(p, m) || fail("pushes after concat", 0, 0);
+}
+
+// a moved builder keeps editing in place; the one it was moved from starts over empty
+bool moved_transients() {
+    auto t1 = persistent_vector<int>().as_transient();
+    for (int i = 0; i < 10; ++i) {
+        t1.push_back(i);
+    }
+    auto t2 = std::move(t1);
+    t1.push_back(100);
+    t2.push_back(200);
+    if (t1.size() != 1 || t1[0] != 100) return fail("moved-from transient", 0, 0);
+    if (t2.size() != 11 || t2[5] != 5 || t2[10] != 200) return fail("moved-to transient", 0, 0);
+    t1 = std::move(t2);
+    t1.update(3, -3);
+    const persistent_vector<int> p = t1.persistent();
+    t1.update(4, -4);
+    return (p.size() == 11 && p[3] == -3 && p[4] == 4) || fail("transient after move assignment", 0, 0);
+}
+
+// versions are shared between threads that derive new versions from them at the same time
+bool concurrent_versions() {
+    persistent_vector<int> base;
+    model m;
+    for (int i = 0; i < 5000; ++i) {
+        base = base.push_back(i);
+        m.push_back(i);
+    }
+    bool ok[4] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            persistent_vector<int> mine = base;
+            for (int i = 0; i < 2000; ++i) {
+                mine = mine.update(static_cast<std::size_t>(i * 7) % m.size(), t).push_back(t).pop_back();
+            }
+            ok[t] = same(base, m);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (bool result : ok) {
+        if (!result) return fail("a shared version was modified by another thread", 0, 0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned trials = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 300;
+    const unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1;
+
+    if (!pushes_after_concat() || !moved_transients() || !concurrent_versions()) return 1;
+    std::mt19937 rng(seed);
+    for (unsigned trial = 0; trial < trials; ++trial) {
+        if (!random_versions(trial, rng)) return 1;
+    }
+    std::printf("ok: %u trials\n", trials);
+    return 0;
+}
@@ -5,8 +5,138 @@
 
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "vector_exceptions.h"
+
+/* Heap profiling. With VECTOR_HEAP_PROFILE defined every constructor takes a defaulted
+* std::source_location, so each vector is attributed to the line that created it (see vector_profiler.h) */
+#ifdef VECTOR_HEAP_PROFILE
+#include <source_location>
+#include <typeinfo>
+#include "vector_profiler.h"
+#define VECTOR_SITE_PARAM std::source_location site = std::source_location::current()
+// the default constructor then takes one argument; explicit keeps it from converting a source_location into a vector
+#define VECTOR_SITE_EXPLICIT explicit
+#define VECTOR_SITE_PARAM_NEXT , VECTOR_SITE_PARAM
+#define VECTOR_SITE_DEF std::source_location site
+#define VECTOR_SITE_DEF_NEXT , VECTOR_SITE_DEF
+#define VECTOR_SITE_ARG site
+#define VECTOR_SITE_ARG_NEXT , site
+#else
+#define VECTOR_SITE_PARAM
+#define VECTOR_SITE_EXPLICIT
+#define VECTOR_SITE_PARAM_NEXT
+#define VECTOR_SITE_DEF
+#define VECTOR_SITE_DEF_NEXT
+#define VECTOR_SITE_ARG
+#define VECTOR_SITE_ARG_NEXT
+#endif
+
+/* Radix sort keys. radix_key_traits<K> maps a key to 'bytes' unsigned digits (digit(key, 0) is the least
+* significant) whose lexicographic order is the order of the keys. Specialize it to sort by other key types */
+template <typename K>
+struct radix_key_traits {};
+
+template <typename K> requires (std::is_integral_v<K> && !std::is_same_v<K, bool>)
+struct radix_key_traits<K> {
+    static constexpr std::size_t bytes = sizeof(K);
+
+    static constexpr unsigned digit(const K& key, std::size_t byte) noexcept {
+        using U = std::make_unsigned_t<K>;
+        U bits = static_cast<U>(key);
+        if constexpr (std::is_signed_v<K>) {
+            // two's complement: flipping the sign bit puts the negative values first
+            bits ^= static_cast<U>(U(1) << (bytes * 8 - 1));
+        }
+        return static_cast<unsigned>((bits >> (byte * 8)) & 0xFF);
+    }
+};
+
+template <typename K> requires (std::is_floating_point_v<K> && (sizeof(K) == 4 || sizeof(K) == 8))
+struct radix_key_traits<K> {
+    static constexpr std::size_t bytes = sizeof(K);
+
+    static constexpr unsigned digit(const K& key, std::size_t byte) noexcept {
+        using U = std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+        constexpr U sign = U(1) << (bytes * 8 - 1);
+        U bits = std::bit_cast<U>(key);
+        // negative values: flip every bit (larger magnitudes first); positive values: set the sign bit
+        bits ^= (bits & sign) ? ~U(0) : sign;
+        return static_cast<unsigned>((bits >> (byte * 8)) & 0xFF);
+    }
+};
+
+template <typename A, typename B>
+struct radix_key_traits<std::pair<A, B>> {
+    using first_traits = radix_key_traits<std::remove_cvref_t<A>>;
+    using second_traits = radix_key_traits<std::remove_cvref_t<B>>;
+
+    static constexpr std::size_t bytes = first_traits::bytes + second_traits::bytes;
+
+    static constexpr unsigned digit(const std::pair<A, B>& key, std::size_t byte) noexcept {
+        return byte < second_traits::bytes ? second_traits::digit(key.second, byte)
+            : first_traits::digit(key.first, byte - second_traits::bytes);
+    }
+};
+
+template <typename... Ts>
+struct radix_key_traits<std::tuple<Ts...>> {
+    static constexpr std::size_t bytes = (radix_key_traits<std::remove_cvref_t<Ts>>::bytes + ... + 0);
+
+    static constexpr unsigned digit(const std::tuple<Ts...>& key, std::size_t byte) noexcept {
+        return component_digit<sizeof...(Ts)>(key, byte);
+    }
+
+private:
+    // the last component is the least significant one
+    template <std::size_t I>
+    static constexpr unsigned component_digit(const std::tuple<Ts...>& key, std::size_t byte) noexcept {
+        if constexpr (I == 0) {
+            return 0;
+        }
+        else {
+            using traits = radix_key_traits<std::remove_cvref_t<std::tuple_element_t<I - 1, std::tuple<Ts...>>>>;
+            return byte < traits::bytes ? traits::digit(std::get<I - 1>(key), byte)
+                : component_digit<I - 1>(key, byte - traits::bytes);
+        }
+    }
+};
+
+template <typename K>
+concept radix_key = requires(const K& key) {
+    { radix_key_traits<K>::bytes } -> std::convertible_to<std::size_t>;
+    { radix_key_traits<K>::digit(key, std::size_t()) } -> std::convertible_to<unsigned>;
+};
+
+/* An allocator may declare 'static constexpr std::size_t capacity_granularity'. vector then rounds every
+* capacity up to a multiple of it, e.g. so SIMD kernels can read whole registers past size() (see aligned_allocator.h) */
+template <typename Alloc>
+inline constexpr std::size_t capacity_granularity_v = 1;
+
+template <typename Alloc> requires requires { { Alloc::capacity_granularity } -> std::convertible_to<std::size_t>; }
+inline constexpr std::size_t capacity_granularity_v<Alloc> = Alloc::capacity_granularity;
+
+// Result of the non-throwing vector operations (try_reserve, try_push_back, try_insert)
+enum class vector_errc {
+    ok,
+    out_of_range,
+    length_error,
+    bad_alloc
+};
 
 template <typename T, typename Alloc = std::allocator<T>>
 class vector {
@@ -20,81 +150,88 @@ class vector {
         using reference = std::conditional_t<IsConst, const T&, T&>;
         using difference_type = std::ptrdiff_t;
         using iterator_category = std::random_access_iterator_tag;
+        // std::contiguous_iterator: elements are adjacent in memory, so algorithms may work on std::to_address
+        using iterator_concept = std::contiguous_iterator_tag;
         using value_type = T;
+        using element_type = std::conditional_t<IsConst, const T, T>;
 
     private:
-        pointer ptr;
-        friend class vector<T>;
+        pointer ptr = nullptr;
+        friend class vector;
 
     public:
-        base_iterator(T* ptr) : ptr(ptr) {}
-        base_iterator(const base_iterator&) = default;
-        base_iterator& operator=(const base_iterator&) = default;
+        constexpr base_iterator() noexcept = default;
+        constexpr base_iterator(pointer ptr) noexcept : ptr(ptr) {}
+        constexpr base_iterator(const base_iterator&) = default;
+        constexpr base_iterator& operator=(const base_iterator&) = default;
 
-        operator base_iterator<true>() const { return ptr; }
-        reference operator*() const { return *ptr; }
-        pointer operator->() const { return ptr; }
+        constexpr operator base_iterator<true>() const { return ptr; }
+        constexpr reference operator*() const { return *ptr; }
+        constexpr pointer operator->() const { return ptr; }
 
-        base_iterator& operator++() {
+        constexpr base_iterator& operator++() {
             ++ptr;
             return *this;
         }
 
-        base_iterator operator++(int) {
+        constexpr base_iterator operator++(int) {
             base_iterator copy = *this;
             ++ptr;
             return copy;
         }
 
-        base_iterator& operator+=(difference_type n) {
+        constexpr base_iterator& operator+=(difference_type n) {
             ptr = ptr + n;
             return *this;
         }
 
-        base_iterator operator+(difference_type n) {
+        constexpr base_iterator operator+(difference_type n) const {
             base_iterator temp = *this;
             temp += n;
             return temp;
         }
 
-        base_iterator& operator--() {
+        friend constexpr base_iterator operator+(difference_type n, const base_iterator& it) { return it + n; }
+
+        constexpr base_iterator& operator--() {
             --ptr;
             return *this;
         }
 
-        base_iterator operator--(int) {
+        constexpr base_iterator operator--(int) {
             base_iterator copy = *this;
             --ptr;
             return copy;
         }
 
-        base_iterator& operator-=(difference_type n) {
+        constexpr base_iterator& operator-=(difference_type n) {
             ptr = ptr - n;
             return *this;
         }
 
-        base_iterator operator-(difference_type n) {
+        constexpr base_iterator operator-(difference_type n) const {
             base_iterator temp = *this;
             temp -= n;
             return temp;
         }
 
-        difference_type operator-(const base_iterator& other) const { return ptr - other.ptr; }
+        constexpr reference operator[](difference_type n) const { return *(ptr + n); }
 
-        reference operator[](difference_type n) const { return *(ptr + n); }
+        // hidden friends, so an iterator and a const_iterator can be mixed through the conversion above
 
+        friend constexpr difference_type operator-(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr - rhs.ptr; }
 
-        bool operator==(const base_iterator& other) const { return ptr == other.ptr; }
+        friend constexpr bool operator==(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr == rhs.ptr; }
 
-        bool operator!=(const base_iterator& other) const { return !(ptr == other.ptr); }
+        friend constexpr bool operator!=(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr != rhs.ptr; }
 
-        bool operator<(const base_iterator& other)  const { return ptr < other.ptr; }
+        friend constexpr bool operator<(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr < rhs.ptr; }
 
-        bool operator>(const base_iterator& other)  const { return ptr > other.ptr; }
+        friend constexpr bool operator>(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr > rhs.ptr; }
 
-        bool operator<=(const base_iterator& other) const { return ptr <= other.ptr; }
+        friend constexpr bool operator<=(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr <= rhs.ptr; }
 
-        bool operator>=(const base_iterator& other) const { return ptr >= other.ptr; }
+        friend constexpr bool operator>=(const base_iterator& lhs, const base_iterator& rhs) { return lhs.ptr >= rhs.ptr; }
 
     }; // END OF base_iterator
 
@@ -130,204 +267,387 @@ public:
     //  ITERATORS
 
     // returns a read / write iterator that points to the first element in the vector
-    [[nodiscard]] iterator begin() { return arr_; }
+    [[nodiscard]] constexpr iterator begin() { return arr_; }
 
     // returns a read / write iterator that points one past the last element in the vector
-    [[nodiscard]] iterator end() { return arr_ + sz_; }
+    [[nodiscard]] constexpr iterator end() { return arr_ + sz_; }
 
     // returns a read - only (constant) iterator that points to the first element in the vector
-    [[nodiscard]] const_iterator begin()   const { return arr_; }
+    [[nodiscard]] constexpr const_iterator begin()   const { return arr_; }
 
     // returns a read - only (constant) iterator that points one past the last element in the vector
-    [[nodiscard]] const_iterator end()     const { return arr_ + sz_; }
+    [[nodiscard]] constexpr const_iterator end()     const { return arr_ + sz_; }
 
     // returns a read - only (constant) iterator that points to the first element in the vector
-    [[nodiscard]] const_iterator cbegin()  const { return arr_; }
+    [[nodiscard]] constexpr const_iterator cbegin()  const { return arr_; }
 
     // returns a read - only (constant) iterator that points one past the last element in the vector
-    [[nodiscard]] const_iterator cend()    const { return arr_ + sz_; }
+    [[nodiscard]] constexpr const_iterator cend()    const { return arr_ + sz_; }
 
     // returns a read / write reverse iterator that points to the last element in the vector
-    [[nodiscard]] reverse_iterator rbegin() { return reverse_iterator(end()); }
+    [[nodiscard]] constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
 
     // returns a read / write reverse iterator that points to one before the first element in the vector
-    [[nodiscard]] reverse_iterator rend() { return reverse_iterator(begin()); }
+    [[nodiscard]] constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
 
     // returns a read - only (constant) reverse iterator that points to the last element in the vector.
-    [[nodiscard]] const_reverse_iterator rbegin() const { return reverse_iterator(end()); }
+    [[nodiscard]] constexpr const_reverse_iterator rbegin() const { return reverse_iterator(end()); }
 
     // returns a read - only (constant) reverse iterator that points to one before the first element in the vector.
-    [[nodiscard]] const_reverse_iterator rend() const { return reverse_iterator(begin()); }
+    [[nodiscard]] constexpr const_reverse_iterator rend() const { return reverse_iterator(begin()); }
 
     // returns a read - only (constant) reverse iterator that points to the last element in the vector
-    [[nodiscard]] const_reverse_iterator crbegin() const { return reverse_iterator(end()); }
+    [[nodiscard]] constexpr const_reverse_iterator crbegin() const { return reverse_iterator(end()); }
 
     // returns a read - only (constant) reverse iterator that points to one before the first element in the vector
-    [[nodiscard]] const_reverse_iterator crend() const { return reverse_iterator(begin()); }
+    [[nodiscard]] constexpr const_reverse_iterator crend() const { return reverse_iterator(begin()); }
         
     // +++++++++++++++++++ CONSTRUCTORS, DTOR +++++++++++++++++++
     // strong exception guarantee
 
     // Default constructor. Constructs an empty container
-    vector();
+    VECTOR_SITE_EXPLICIT constexpr vector(VECTOR_SITE_PARAM);
 
     //  Constructs the container with 'sz' default-inserted instances of T
-    explicit vector(size_type sz);
+    constexpr explicit vector(size_type sz VECTOR_SITE_PARAM_NEXT);
 
     // Constructs the container with the contents of the initializer list
-    vector(std::initializer_list<T>);
+    constexpr vector(std::initializer_list<T> VECTOR_SITE_PARAM_NEXT);
 
     // Constructs the container with 'sz' copies of elements with value 'value'
-    explicit vector(size_type sz, const_reference value);
+    constexpr explicit vector(size_type sz, const_reference value VECTOR_SITE_PARAM_NEXT);
 
     // Constructs the container with the contents of the range [first, last]
-    template <typename InputIt>
-    vector(InputIt first, InputIt last);
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    constexpr vector(InputIt first, InputIt last VECTOR_SITE_PARAM_NEXT);
 
     // Copy constructor. Constructs the container with the copy of the contents of 'other'
-    vector(const vector&);
+    constexpr vector(const vector& VECTOR_SITE_PARAM_NEXT);
 
     // Move constructor. Constructs the container with the contents of 'other' using move semantics.
-    vector(vector&&) noexcept;
+    constexpr vector(vector&& VECTOR_SITE_PARAM_NEXT) noexcept;
 
     // A Destructor. Destructs the vector
-    ~vector() noexcept;
+    constexpr ~vector() noexcept;
 
     // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
 
     // Returns a read - write reference to the element at specified location 'index'. No bounds checking is performed.
-    reference operator[](size_type index) noexcept;
+    constexpr reference operator[](size_type index) noexcept;
 
     // Returns a read - only reference to the element at specified location 'index'. No bounds checking is performed.
-    const_reference operator[](size_type index) const noexcept;
+    constexpr const_reference operator[](size_type index) const noexcept;
 
     // Returns a read - write reference to the element at specified location 'index', with bounds checking.
-    reference at(size_type index);
+    constexpr reference at(size_type index);
 
     // Returns a read - only reference to the element at specified location 'index', with bounds checking.
-    const_reference at(size_type index) const;
+    constexpr const_reference at(size_type index) const;
 
     // Returns a read - write reference to the first element in the container.
-    reference front();
+    constexpr reference front();
 
     // Returns a read - only reference to the first element in the container.
-    const_reference front() const;
+    constexpr const_reference front() const;
 
     // Returns a read - write reference to the last element in the container.
-    reference back();
+    constexpr reference back();
 
     // Returns a read - only reference to the last element in the container.
-    const_reference back() const;
+    constexpr const_reference back() const;
+
+    // Returns a pointer to the underlying array. [data(), data() + size()) is always a valid range
+    constexpr pointer data() noexcept;
+
+    // Returns a read - only pointer to the underlying array
+    constexpr const_pointer data() const noexcept;
 
     // +++++++++++++++++++ CAPACITY +++++++++++++++++++
 
     // Returns the number of elements in the container
-    const size_type size() const noexcept;
+    constexpr const size_type size() const noexcept;
 
     // Returns the number of elements that the container has currently allocated space for
-    const size_type capacity() const noexcept;
+    constexpr const size_type capacity() const noexcept;
 
     /* Increase the capacity of the vector to a 'newcap' 
     * If 'newcap' is greater than capacity(), all iterators and all references to the elements are invalidated */
-    void reserve(size_type newcap);
+    constexpr void reserve(size_type newcap);
+
+    /* reserve without exceptions: returns length_error if 'newcap' > max_size() and bad_alloc if the
+    * allocator fails (throws, or returns nullptr when built without exceptions). The vector is unchanged on failure */
+    [[nodiscard]] constexpr vector_errc try_reserve(size_type newcap);
 
     // Checks if the container has no elements
-    bool empty() const;
+    constexpr bool empty() const;
 
     // Reduces memory usage by freeing unused memory
-    void shrink_to_fit();
+    constexpr void shrink_to_fit();
+
+    /* Opt-in automatic shrinking: once pop_back, erase, resize or clear leave fewer than
+    * capacity() / 'divisor' elements, the capacity drops to twice the size (e.g. 4 = halve at a quarter).
+    * Twice the size would sit right at the trigger again for divisors 1 and 2, so with those the capacity
+    * is halved instead, once the size fits in half of it. 0 (the default) disables it. Copies and moved-to containers inherit the policy, whether constructed
+    * or assigned, and swap exchanges it */
+    constexpr void set_shrink_policy(size_type divisor) noexcept;
+
+    // Returns the shrink divisor, 0 if automatic shrinking is disabled
+    constexpr size_type shrink_policy() const noexcept;
 
     // Returns the maximum possible number of elements
-    size_type max_size() const noexcept;
+    constexpr size_type max_size() const noexcept;
 
     // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
 
     // Appends a new element to the end of the container
     template <typename... Args>
-    void emplace_back(Args&&... args);
+    constexpr void emplace_back(Args&&... args);
+
+    /* Constructs an element in place before 'pos' from 'args', without a temporary unless an argument
+    * refers to an element of this vector. Returns an iterator to the new element */
+    template <typename... Args>
+    constexpr iterator emplace(const_iterator pos, Args&&... args);
 
     // Appends the given element 'value' to the end of the container. Copy
-    void push_back(const value_type& value);
+    constexpr void push_back(const value_type& value);
 
     // Appends the given element 'value' to the end of the container. Move
-    void push_back(value_type&& value);
+    constexpr void push_back(value_type&& value);
+
+    // Appends a copy of 'value' like push_back, but reports allocation failure instead of throwing (see try_reserve)
+    [[nodiscard]] constexpr vector_errc try_push_back(const value_type& value);
+
+    // Appends 'value' like push_back, but reports allocation failure instead of throwing (see try_reserve)
+    [[nodiscard]] constexpr vector_errc try_push_back(value_type&& value);
 
     // Inserts a copy of 'value' before 'pos'
-    iterator insert(const_iterator pos, const T& value);
+    constexpr iterator insert(const_iterator pos, const T& value);
 
     // Inserts 'value' before 'pos', possibly using move-semantics
-    iterator insert(const_iterator pos, T&& value);
+    constexpr iterator insert(const_iterator pos, T&& value);
 
     // Inserts 'count' copies of the 'value' before 'pos'
-    iterator insert(const_iterator pos, size_type count, const T& value);
+    constexpr iterator insert(const_iterator pos, size_type count, const T& value);
 
     // Inserts elements from range [first, last] before 'pos'
-    template< class InputIt >
-    iterator insert(const_iterator pos, InputIt first, InputIt last);
+    template< class InputIt > requires (!std::is_integral_v<InputIt>)
+    constexpr iterator insert(const_iterator pos, InputIt first, InputIt last);
 
     // Inserts elements from initializer list 'ilist' before 'pos'
-    iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+    constexpr iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+
+    /* Inserts values[i] before the element at index 'positions[i]' (sorted ascending, size() allowed; equal positions
+    * keep the order of their values) in one O(size() + k) pass, reallocating at most once. Positions refer to the
+    * vector before the call. Throws std::out_of_range (leaving the vector unchanged) if a position is out of range
+    * or the span is unsorted */
+    template <std::random_access_iterator RandomIt>
+    constexpr void insert_many(std::span<const size_type> positions, RandomIt values);
+
+    // Inserts a copy of 'value' before 'pos'. Returns out_of_range for an invalid 'pos', otherwise as try_push_back
+    [[nodiscard]] constexpr vector_errc try_insert(const_iterator pos, const T& value);
+
+    // Inserts 'value' before 'pos'. Returns out_of_range for an invalid 'pos', otherwise as try_push_back
+    [[nodiscard]] constexpr vector_errc try_insert(const_iterator pos, T&& value);
 
     // Removes the last element
-    void pop_back() noexcept;
+    constexpr void pop_back() noexcept;
     
     // Clears the contents
-    void clear();
+    constexpr void clear();
 
     // Swaps the contents
-    void swap(vector&) noexcept;
+    constexpr void swap(vector&) noexcept;
 
     // Changes the number of elements stored
-    void resize(size_type);
+    constexpr void resize(size_type);
 
     // Changes the number of elements stored. Additional copies of 'value' are appended
-    void resize(size_type, const value_type& value);
+    constexpr void resize(size_type, const value_type& value);
 
     // Removes the element at 'pos'
-    iterator erase(iterator pos);
+    constexpr iterator erase(iterator pos);
 
     // Removes the element at 'pos'
-    const_iterator erase(const_iterator pos);
+    constexpr const_iterator erase(const_iterator pos);
 
     // Removes the elements in the range [first, last]
-    iterator erase(iterator first, iterator last);
+    constexpr iterator erase(iterator first, iterator last);
 
     // Removes the elements in the range [first, last]
-    const_iterator erase(const_iterator first, const_iterator last);
+    constexpr const_iterator erase(const_iterator first, const_iterator last);
+
+    /* Removes all elements for which 'pred' returns true in a single pass. 
+    * Survivors keep their order and are relocated at most once. Returns the number of removed elements.
+    * If 'pred' throws, the elements it has not seen yet are kept */
+    template <typename Pred>
+    constexpr size_type erase_if(Pred pred);
+
+    // Removes all elements equal to 'value' in a single pass. Returns the number of removed elements
+    constexpr size_type remove_values(const T& value);
+
+    /* Removes the elements at 'indices' (sorted ascending, duplicates allowed) in a single pass.
+    * Throws std::out_of_range (leaving the vector unchanged) if an index is out of range or the span is unsorted */
+    constexpr size_type erase_indices(std::span<const size_type> indices);
+
+    /* Removes the element at 'pos' in O(1) by moving the last element into its place. Does not preserve order.
+    * Returns an iterator to the element that took the place of the removed one */
+    constexpr iterator erase_unordered(const_iterator pos);
+
+    /* Removes the elements at 'indices' (sorted ascending, duplicates allowed) by swap-and-pop, O(indices.size()).
+    * Does not preserve order. Throws std::out_of_range (leaving the vector unchanged) on bad input */
+    constexpr size_type erase_unordered(std::span<const size_type> indices);
+
+    // BATCHED ACCESS
+
+    /* Copies the elements at 'indices' into 'out' (out[i] = (*this)[indices[i]]), prefetching the element
+    * 'distance' indices ahead so that many cache misses are in flight at once.
+    * Throws std::invalid_argument if 'out' is too small and std::out_of_range if an index is out of range */
+    constexpr void gather(std::span<const size_type> indices, std::span<T> out, size_type distance = 16) const;
+
+    /* Stores values[i] at indices[i], prefetching 'distance' indices ahead. Later entries win on duplicate indices.
+    * Throws std::invalid_argument if 'values' is too small and std::out_of_range if an index is out of range */
+    constexpr void scatter(std::span<const size_type> indices, std::span<const T> values, size_type distance = 16);
+
+    // SORTING
+
+    /* Sorts the elements in ascending order with a stable LSD radix sort, one pass per key byte
+    * (passes where all elements share the digit are skipped). T must satisfy radix_key: an integral or
+    * floating-point type, or a pair/tuple of those. Trivially copyable elements are sorted by 'threads'
+    * threads (0: hardware concurrency) when there are enough of them. The scratch buffer comes from the allocator */
+    void radix_sort(unsigned threads = 0) requires radix_key<T>;
+
+    /* Stable radix sort by key_fn(element), which must return a radix_key type. key_fn must be noexcept and
+    * safe to call from several threads at once: it is called several times per element, concurrently by
+    * the sorting threads. Elements without a nothrow move constructor, very short vectors, and vectors for
+    * which no scratch buffer can be allocated are sorted by comparison instead */
+    template <typename KeyFn> requires std::is_nothrow_invocable_v<KeyFn&, const T&>
+    void radix_sort_by_key(KeyFn key_fn, unsigned threads = 0);
 
     // MEMBER FUNCTIONS
 
-    // Copy assignment operator
-    vector& operator=(const vector&);
+    // Copy assignment operator. Reuses the current buffer when it is large enough
+    constexpr vector& operator=(const vector&);
 
-    // Move assignment operator
-    vector& operator=(vector&&) noexcept;
+    // Move assignment operator. Takes over the buffer of 'other' unless the allocators differ and do not propagate,
+    // in which case the elements are moved one by one into storage from this container's allocator
+    constexpr vector& operator=(vector&&) noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value
+        || std::allocator_traits<Alloc>::is_always_equal::value);
 
     // Returns the allocator associated with the container
-    allocator_type get_allocator() const noexcept;
+    constexpr allocator_type get_allocator() const noexcept;
 
-    // Replaces the contents of the container
-    void assign(size_type count, const T& value);
+    // Replaces the contents with 'count' copies of 'value', reusing the current buffer when it is large enough
+    constexpr void assign(size_type count, const T& value);
+
+    // Replaces the contents with the range [first, last], reusing the current buffer when it is large enough
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    constexpr void assign(InputIt first, InputIt last);
+
+    // Replaces the contents with the elements of the initializer list, reusing the current buffer when it is large enough
+    constexpr void assign(std::initializer_list<T> ilist);
 
     // OTHER
 
+#ifdef VECTOR_HEAP_PROFILE
+    // Attributes this vector to 'tag' instead of its construction site in heap profiles
+    void set_profile_tag(const char* tag);
+#endif
+
 private:
-    // helper insert method
-    iterator insert_impl(const_iterator, T&&);
+    // heap profiler hooks, no-ops unless VECTOR_HEAP_PROFILE is defined
+#ifdef VECTOR_HEAP_PROFILE
+    constexpr void profile_register(const std::source_location&) noexcept;
+#else
+    constexpr void profile_register() noexcept;
+#endif
+    constexpr void profile_unregister() noexcept;
+    constexpr void profile_reallocation() noexcept;
+    // reports the capacity after the buffer moved to or from another vector
+    constexpr void profile_sizes() noexcept;
+    // publishes size() to the profiler; called after every change of sz_
+    constexpr void profile_size() noexcept;
+
+    // replaces the contents with 'count' elements read from 'first'
+    template <typename ForwardIt>
+    constexpr void assign_counted(ForwardIt first, size_type count);
+
+    // moves the elements into a buffer of 'newcap' (>= sz_) elements, frees the buffer when 'newcap' is 0
+    constexpr void shrink_capacity(size_type newcap);
+
+    // moves the elements into a new buffer of 'newcap' (>= sz_) elements; false if the allocator returned nullptr
+    constexpr bool reallocate(size_type newcap);
+
+    // inserts std::forward<U>(value) at 'index' (<= sz_), growing first if the vector is full; for the try_ functions
+    template <typename U>
+    constexpr vector_errc try_insert_at(size_type index, U&& value);
+
+    // applies the shrink policy after elements were removed; keeps the buffer if reallocation fails
+    constexpr void maybe_shrink() noexcept;
+
+    /* allocates a buffer for at least 'n' elements and stores its real capacity back into 'n'.
+    * Uses allocate_at_least when the allocator has it, so size-class slack becomes usable capacity */
+    constexpr pointer allocate_buffer(size_type& n);
+
+    // allocate_buffer that returns nullptr (with 'n' = 0) instead of failing when a non-throwing allocator runs out
+    constexpr pointer try_allocate_buffer(size_type& n);
+
+    // rounds a requested capacity up to the allocator's capacity_granularity
+    static constexpr size_type round_capacity(size_type n) noexcept;
+
+    // emplace into a full vector: the new element is constructed in the new buffer before anything is relocated
+    template <typename... Args>
+    constexpr iterator emplace_reallocate(size_type index, Args&&... args);
+
+    // checks if any of the emplace arguments lies inside the elements, where shifting would overwrite it
+    template <typename... Args>
+    bool args_in_buffer(const Args&... args) const noexcept;
+
+    // single-pass removal of the elements for which 'remove(index, element)' is true
+    template <typename Pred>
+    constexpr size_type compact(Pred remove);
+
+    // checks if 'p' points to one of the elements (an argument aliasing the container)
+    constexpr bool in_buffer(const T* p) const noexcept;
+
+    // the LSD passes of radix_sort_by_key, moving the elements between arr_ and 'scratch' (capacity 'scratch_cap')
+    template <typename KeyOf>
+    void radix_passes(KeyOf& key_of, T* scratch, size_type scratch_cap, size_type* counts, size_type workers) noexcept;
+
+    // runs fn(0) ... fn(workers - 1), on separate threads when they can be started
+    template <typename Fn>
+    static void run_workers(size_type workers, Fn& fn) noexcept;
+
+    // validates the arguments of gather and scatter
+    constexpr void check_batch(std::span<const size_type> indices, size_type count) const;
+
+    // hints the cache to fetch the element at 'p'; 'Write' when it is about to be stored to
+    template <bool Write>
+    static constexpr void prefetch(const T* p) noexcept;
+
+    // below this size radix_sort_by_key sorts by comparison
+    static constexpr size_type radix_sort_cutoff = 256;
+
+    // the least number of elements given to each radix sort thread
+    static constexpr size_type radix_min_chunk = size_type(1) << 16;
 
     // different iterator categories version
     template <typename InputIt>
-    iterator insert_dispatch(const_iterator, InputIt, InputIt, float); 
+    constexpr iterator insert_dispatch(const_iterator, InputIt, InputIt, float); 
 
     // same iterator categories version
     template <typename InputIt>
-    iterator insert_dispatch(const_iterator, InputIt, InputIt, int);
+    constexpr iterator insert_dispatch(const_iterator, InputIt, InputIt, int);
 
 private:
     T* arr_;
     size_t sz_;
     size_t cap_;
+    size_t shrink_divisor_ = 0;
     [[no_unique_address]] Alloc alloc_;
+#ifdef VECTOR_HEAP_PROFILE
+    // sz_ * sizeof(T) for the profiler, which reads it from other threads
+    std::atomic<size_t> profile_live_bytes_{ 0 };
+#endif
     using alloc_traits = std::allocator_traits<Alloc>;
 };
 
@@ -337,268 +657,418 @@ private:
 
     // default ctor
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector() : arr_(nullptr), sz_(0), cap_(0) {}
+constexpr vector<T, Alloc>::vector(VECTOR_SITE_DEF) : arr_(nullptr), sz_(0), cap_(0) {
+    profile_register(VECTOR_SITE_ARG);
+}
 
     // ctor from size
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector(size_type sz) : sz_(sz), cap_(sz) {
-    arr_ = alloc_traits::allocate(alloc_, cap_);
+constexpr vector<T, Alloc>::vector(size_type sz VECTOR_SITE_DEF_NEXT) : sz_(sz), cap_(round_capacity(sz)) {
+    arr_ = allocate_buffer(cap_);
     size_type index = 0;
-    try {
+    VECTOR_TRY {
         for (; index < sz_; ++index) {
             alloc_traits::construct(alloc_, arr_ + index);
         }
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, arr_ + new_index);
         }
         alloc_traits::deallocate(alloc_, arr_, cap_);
-        throw;
+        VECTOR_RETHROW;
     }
+    profile_register(VECTOR_SITE_ARG);
 }
 
     // ctor from std::initializer_list
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector(std::initializer_list<T> init_list) : arr_(nullptr), sz_(init_list.size()), cap_(init_list.size()) {
-    arr_ = alloc_traits::allocate(alloc_, cap_);
+constexpr vector<T, Alloc>::vector(std::initializer_list<T> init_list VECTOR_SITE_DEF_NEXT) : arr_(nullptr), sz_(init_list.size()), cap_(round_capacity(init_list.size())) {
+    arr_ = allocate_buffer(cap_);
     size_type index = 0;
-    try {
+    VECTOR_TRY {
         for (const_reference value : init_list) {
             alloc_traits::construct(alloc_, arr_ + index, value);
             ++index;
         }
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, arr_ + new_index);
         }
         alloc_traits::deallocate(alloc_, arr_, cap_);
-        throw;
+        VECTOR_RETHROW;
     }
+    profile_register(VECTOR_SITE_ARG);
 }
 
     // ctor from size and value
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector(size_type sz, const_reference value) : arr_(nullptr), sz_(sz), cap_(sz) {
-    arr_ = alloc_traits::allocate(alloc_, cap_);
+constexpr vector<T, Alloc>::vector(size_type sz, const_reference value VECTOR_SITE_DEF_NEXT) : arr_(nullptr), sz_(sz), cap_(round_capacity(sz)) {
+    arr_ = allocate_buffer(cap_);
     size_type index = 0;
-    try {
+    VECTOR_TRY {
         for (; index < sz_; ++index) {
             alloc_traits::construct(alloc_, arr_ + index, value);
         }
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, arr_ + new_index);
         }
         alloc_traits::deallocate(alloc_, arr_, cap_);
-        throw;
+        VECTOR_RETHROW;
     }
+    profile_register(VECTOR_SITE_ARG);
 }
 
     // ctor from iterators. !!! remember - iterators must be from the same container.
 template<typename T, typename Alloc> 
-template<typename InputIt>
-inline vector<T, Alloc>::vector(InputIt first, InputIt last) : arr_(nullptr), sz_(0), cap_(0) {
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+constexpr vector<T, Alloc>::vector(InputIt first, InputIt last VECTOR_SITE_DEF_NEXT) : arr_(nullptr), sz_(0), cap_(0) {
     size_type count = std::distance(first, last);
-    cap_ = count;
-    arr_ = alloc_traits::allocate(alloc_, cap_);
+    cap_ = round_capacity(count);
+    arr_ = allocate_buffer(cap_);
     size_type index = 0;
 
-    try {
+    VECTOR_TRY {
         for (; first != last; ++first, ++index) {
             alloc_traits::construct(alloc_, arr_ + index, *first);
         }
         sz_ = index;
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, arr_ + new_index);
         }
         alloc_traits::deallocate(alloc_, arr_, cap_);
-        throw;
+        VECTOR_RETHROW;
     }
+    profile_register(VECTOR_SITE_ARG);
 };
 
     // copy ctor;
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector(const vector& other)
-    : sz_(other.sz_), cap_(other.cap_), alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
-    arr_ = alloc_traits::allocate(alloc_, cap_);
+constexpr vector<T, Alloc>::vector(const vector& other VECTOR_SITE_DEF_NEXT)
+    : sz_(other.sz_), cap_(other.cap_), shrink_divisor_(other.shrink_divisor_),
+      alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+    arr_ = allocate_buffer(cap_);
     size_type index = 0;
-    try {
+    VECTOR_TRY {
         for (; index < sz_; ++index) {
             alloc_traits::construct(alloc_, arr_ + index, other.arr_[index]);
         }
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, arr_ + new_index);
         }
         alloc_traits::deallocate(alloc_, arr_, cap_);
-        throw;
+        VECTOR_RETHROW;
     }
+    profile_register(VECTOR_SITE_ARG);
 }
 
     // move ctor
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>::vector(vector&& other) noexcept {
-    if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+constexpr vector<T, Alloc>::vector(vector&& other VECTOR_SITE_DEF_NEXT) noexcept
+    : shrink_divisor_(other.shrink_divisor_), alloc_(std::move(other.alloc_)) {
     arr_ = other.arr_; other.arr_ = nullptr;
     sz_ = other.sz_;   other.sz_ = 0;
     cap_ = other.cap_; other.cap_ = 0;
+    profile_register(VECTOR_SITE_ARG);
+    other.profile_sizes();
 }
 
     // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
 
 template<typename T, typename Alloc> 
-inline T& vector<T, Alloc>::operator[](size_type index) noexcept {
+constexpr T& vector<T, Alloc>::operator[](size_type index) noexcept {
     return arr_[index];
 }
 
 template<typename T, typename Alloc>
-inline const T& vector<T, Alloc>::operator[](size_type index) const noexcept {
+constexpr const T& vector<T, Alloc>::operator[](size_type index) const noexcept {
     return arr_[index];
 }
 
 template<typename T, typename Alloc>
-inline T& vector<T, Alloc>::at(size_type index) {
+constexpr T& vector<T, Alloc>::at(size_type index) {
     if (index >= sz_) {
-        throw std::out_of_range("index out of range!");
+        VECTOR_THROW(std::out_of_range("index out of range!"));
     }
     return arr_[index];
 }
 
 template<typename T, typename Alloc>
-inline const T& vector<T, Alloc>::at(size_type index) const {
+constexpr const T& vector<T, Alloc>::at(size_type index) const {
     if (index >= sz_) {
-        throw std::out_of_range("index out of range!");
+        VECTOR_THROW(std::out_of_range("index out of range!"));
     }
     return arr_[index];
 }
 
 template<typename T, typename Alloc>
-inline T& vector<T, Alloc>::front() {
-    if (arr_ != nullptr) {
-        return *arr_;
-    }
+constexpr T& vector<T, Alloc>::front() {
+    return *arr_;
 }
 
 template<typename T, typename Alloc>
-inline const T& vector<T, Alloc>::front() const {
-    if (arr_ != nullptr) {
-        return *arr_;
-    }
+constexpr const T& vector<T, Alloc>::front() const {
+    return *arr_;
 }
 
 template<typename T, typename Alloc>
-inline T& vector<T, Alloc>::back() {
-    if (arr_ != nullptr) {
-        return *(arr_ + sz_ - 1);
-    }
+constexpr T& vector<T, Alloc>::back() {
+    return *(arr_ + sz_ - 1);
 }
 
 template<typename T, typename Alloc>
-inline const T& vector<T, Alloc>::back() const {
-    if (arr_ != nullptr) {
-        return *(arr_ + sz_ - 1);
-    }
+constexpr const T& vector<T, Alloc>::back() const {
+    return *(arr_ + sz_ - 1);
+}
+
+template<typename T, typename Alloc>
+constexpr T* vector<T, Alloc>::data() noexcept {
+    return arr_;
+}
+
+template<typename T, typename Alloc>
+constexpr const T* vector<T, Alloc>::data() const noexcept {
+    return arr_;
 }
 
     // +++++++++++++++++++ CAPACITY +++++++++++++++++++
 
 template<typename T, typename Alloc>
-inline const std::size_t vector<T, Alloc>::size() const noexcept {
+constexpr const std::size_t vector<T, Alloc>::size() const noexcept {
     return sz_;
 }
 
 template<typename T, typename Alloc>
-inline const std::size_t vector<T, Alloc>::capacity() const noexcept {
+constexpr const std::size_t vector<T, Alloc>::capacity() const noexcept {
     return cap_;
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::clear() {
+constexpr void vector<T, Alloc>::clear() {
     for (size_type i = 0; i < sz_; ++i) {
         alloc_traits::destroy(alloc_, arr_ + i);
     }
     sz_ = 0;
+    maybe_shrink();
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::reserve(size_type newcap) {
+    if (newcap <= cap_) {
+        return;
+    }
+    if (newcap > max_size()) {
+        VECTOR_THROW(std::length_error("vector::reserve"));
+    }
+    if (!reallocate(round_capacity(newcap))) {
+        VECTOR_THROW(std::bad_alloc());
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr vector_errc vector<T, Alloc>::try_reserve(size_type newcap) {
+    if (newcap <= cap_) {
+        return vector_errc::ok;
+    }
+    if (newcap > max_size()) {
+        return vector_errc::length_error;
+    }
+    VECTOR_TRY {
+        if (!reallocate(round_capacity(newcap))) {
+            return vector_errc::bad_alloc;
+        }
+    }
+    VECTOR_CATCH(const std::bad_alloc&) {
+        return vector_errc::bad_alloc;
+    }
+    return vector_errc::ok;
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::reserve(size_type newcap) {
+constexpr bool vector<T, Alloc>::empty() const {
+    return sz_ == 0;
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::shrink_to_fit() {
+    const size_type newcap = round_capacity(sz_);
+    if (newcap < cap_) {
+        shrink_capacity(newcap);
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::set_shrink_policy(size_type divisor) noexcept {
+    shrink_divisor_ = divisor;
+}
+
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::shrink_policy() const noexcept {
+    return shrink_divisor_;
+}
+
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+}
+
+    // OTHER (private methods - helpers)
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::shrink_capacity(size_type newcap) {
+    if (newcap == 0) {
+        if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+        arr_ = nullptr;
+        cap_ = 0;
+        profile_reallocation();
+        return;
+    }
+    // shrinking is non-binding: if a non-throwing allocator fails, the current buffer stays
+    reallocate(newcap);
+}
+
+template<typename T, typename Alloc>
+constexpr bool vector<T, Alloc>::reallocate(size_type newcap) {
+    pointer newarr = try_allocate_buffer(newcap);
+    if (newarr == nullptr) {
+        return false;
+    }
     size_type index = 0;
-    pointer newarr = alloc_traits::allocate(alloc_, newcap);
-    try {
+    VECTOR_TRY {
         for (; index < sz_; ++index) {
             alloc_traits::construct(alloc_, newarr + index, 
                 std::move_if_noexcept(arr_[index]));
         }
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type new_index = 0; new_index < index; ++new_index) {
             alloc_traits::destroy(alloc_, newarr + new_index);
         }
         alloc_traits::deallocate(alloc_, newarr, newcap);
-        throw;
+        VECTOR_RETHROW;
     }
 
     for (size_type index = 0; index < sz_; ++index) {
         alloc_traits::destroy(alloc_, arr_ + index);
     }
-    alloc_traits::deallocate(alloc_, arr_, cap_);
+    if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
 
     arr_ = newarr;
     cap_ = newcap;
+    profile_reallocation();
+    return true;
 }
 
 template<typename T, typename Alloc>
-inline bool vector<T, Alloc>::empty() const {
-    if (arr_ == nullptr) return true;
-    return false;
+template<typename U>
+constexpr vector_errc vector<T, Alloc>::try_insert_at(size_type index, U&& value) {
+    auto* source = std::addressof(value);
+    if (sz_ == cap_) {
+        // 'value' may be one of the elements: the reallocation moves it, so find it again by index
+        const bool inside = in_buffer(source);
+        const size_type from = inside ? static_cast<size_type>(source - arr_) : 0;
+        const vector_errc err = try_reserve(cap_ > 0 ? cap_ * 2 : 1);
+        if (err != vector_errc::ok) {
+            return err;
+        }
+        if (inside) {
+            source = arr_ + from;
+        }
+    }
+    // there is room now, so neither call reallocates
+    if (index == sz_) {
+        emplace_back(std::forward<U>(*source));
+    }
+    else {
+        insert(cbegin() + index, std::forward<U>(*source));
+    }
+    return vector_errc::ok;
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::shrink_to_fit() {
-    if (sz_ < cap_) {
-        pointer newarr = alloc_traits::allocate(alloc_, sz_);
-        size_type index = 0;
-        try {
-            for (; index < sz_; ++index) {
-                alloc_traits::construct(alloc_, newarr + index, 
-                    std::move_if_noexcept(arr_[index]));
-            }
-        }
-        catch (...) {
-            for (size_type newindex = 0; newindex < index; ++newindex) {
-                alloc_traits::destroy(alloc_, newarr + newindex);
-            }
-            alloc_traits::deallocate(alloc_, newarr, sz_);
-            throw;
-        }
-        for (size_type index = 0; index < sz_; ++index) {
-            alloc_traits::destroy(alloc_, arr_ + index);
-        }
-        alloc_traits::deallocate(alloc_, arr_, cap_);
-        arr_ = newarr;
-        cap_ = sz_;
+constexpr void vector<T, Alloc>::maybe_shrink() noexcept {
+    // every operation that reduces the size ends here
+    profile_size();
+    // an emptied container always gives its buffer back, however small
+    if (shrink_divisor_ == 0 || (sz_ > 0 && sz_ >= cap_ / shrink_divisor_)) {
+        return;
+    }
+    // leave room to grow back by the same amount without immediately reallocating again; below a
+    // divisor of 3 that would already be under the next trigger, so halve the capacity instead
+    const size_type newcap = shrink_divisor_ > 2 || sz_ == 0 ? round_capacity(sz_ * 2) : round_capacity(cap_ / 2);
+    if (newcap >= cap_ || newcap < sz_) {
+        return;
+    }
+    VECTOR_TRY {
+        shrink_capacity(newcap);
+    }
+    VECTOR_CATCH(...) {
+        // the larger buffer is still valid, shrinking is only an optimization
     }
 }
 
 template<typename T, typename Alloc>
-inline std::size_t vector<T, Alloc>::max_size() const noexcept {
-    return std::numeric_limits<size_type>::max() / sizeof(T);
+constexpr vector<T, Alloc>::pointer vector<T, Alloc>::allocate_buffer(size_type& n) {
+    const size_type requested = n;
+    pointer p = try_allocate_buffer(n);
+    if (p == nullptr && requested > 0) {
+        VECTOR_THROW(std::bad_alloc());
+    }
+    return p;
 }
 
-    // OTHER (private methods - helpers)
+template<typename T, typename Alloc>
+constexpr vector<T, Alloc>::pointer vector<T, Alloc>::try_allocate_buffer(size_type& n) {
+    size_type count = n;
+    pointer p;
+#if defined(__cpp_lib_allocate_at_least)
+    // falls back to allocate(n) for allocators without allocate_at_least
+    auto result = alloc_traits::allocate_at_least(alloc_, n);
+    p = result.ptr;
+    count = result.count;
+#else
+    if constexpr (requires { alloc_.allocate_at_least(n); }) {
+        auto result = alloc_.allocate_at_least(n);
+        p = result.ptr;
+        count = result.count;
+    }
+    else {
+        p = alloc_traits::allocate(alloc_, n);
+    }
+#endif
+    // 'n' is already a multiple of the granularity: the extra room is used in whole blocks only
+    constexpr size_type granularity = capacity_granularity_v<Alloc>;
+    if constexpr (granularity > 1) {
+        count -= count % granularity;
+    }
+    n = count;
+    return p;
+}
+
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::round_capacity(size_type n) noexcept {
+    constexpr size_type granularity = capacity_granularity_v<Alloc>;
+    if constexpr (granularity <= 1) {
+        return n;
+    }
+    else {
+        return (n + granularity - 1) / granularity * granularity;
+    }
+}
 
 template<typename T, typename Alloc>
 template<typename InputIt>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterator pos, InputIt first, InputIt last, float) {
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterator pos, InputIt first, InputIt last, float) {
 
     if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     size_type count = std::distance(first, last);
@@ -612,34 +1082,42 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterat
         reserve(std::max(cap_ * 2, sz_ + count));
     }
 
-    try {
-        for (size_type i = sz_; i > index; --i) {
+    size_type i = sz_;
+    size_type built = 0;
+    VECTOR_TRY {
+        for (; i > index; --i) {
             alloc_traits::construct(alloc_, arr_ + i + count - 1,
                 std::move_if_noexcept(arr_[i - 1]));
             alloc_traits::destroy(alloc_, arr_ + i - 1);
         }
-        for (size_type i = 0; i < count; ++i) {
-            alloc_traits::construct(alloc_, arr_ + index + i, *first++);
+        for (; built < count; ++built) {
+            alloc_traits::construct(alloc_, arr_ + index + built, *first++);
         }
         sz_ += count;
+        profile_size();
     }
-    catch (...) {
-        for (size_type i = index + count; i < sz_; ++i) {
-            alloc_traits::destroy(alloc_, arr_ + i);
+    VECTOR_CATCH(...) {
+        // [0, i) is still in place; the elements already moved up and the new ones are dropped
+        for (size_type j = index; j < index + built; ++j) {
+            alloc_traits::destroy(alloc_, arr_ + j);
+        }
+        for (size_type j = i + count; j < sz_ + count; ++j) {
+            alloc_traits::destroy(alloc_, arr_ + j);
         }
-        throw;
+        sz_ = i;
+        profile_size();
+        VECTOR_RETHROW;
     }
 
     return begin() + index;
-
 }
 
 template<typename T, typename Alloc>
 template<typename InputIt>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterator pos, InputIt first, InputIt last, int) {
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterator pos, InputIt first, InputIt last, int) {
 
     if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     size_type count = std::distance(first, last);
@@ -649,164 +1127,283 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert_dispatch(const_iterat
         return begin() + index;
     }
 
-    if (first >= begin() && first < end() && last > begin() && last <= end()) {
-        vector<T> temp(first, last);
-        first = temp.begin();
-        last = temp.end();
-
-        if (sz_ + count > cap_) {
-            reserve(std::max(cap_ * 2, sz_ + count));
+    // only a range of T can be our own elements, which the shifting below would overwrite
+    if constexpr (std::contiguous_iterator<InputIt> && std::is_same_v<std::iter_value_t<InputIt>, T>) {
+        if (in_buffer(std::to_address(first))) {
+            const vector copy(first, last);
+            return insert_dispatch(pos, copy.data(), copy.data() + count, 1);
         }
-
-        try {
-            for (size_type i = sz_; i > index; --i) {
-                alloc_traits::construct(alloc_, arr_ + i + count - 1,
-                    std::move_if_noexcept(arr_[i - 1]));
-                alloc_traits::destroy(alloc_, arr_ + i - 1);
-            }
-            for (size_type i = 0; i < count; ++i) {
-                alloc_traits::construct(alloc_, arr_ + index + i, *first++);
-            }
-            sz_ += count;
-        }
-        catch (...) {
-            for (size_type i = index + count; i < sz_; ++i) {
-                alloc_traits::destroy(alloc_, arr_ + i);
-            }
-            throw;
-        }
-
-        return begin() + index;
     }
 
     if (sz_ + count > cap_) {
         reserve(std::max(cap_ * 2, sz_ + count));
     }
 
-    try {
-        for (size_type i = sz_; i > index; --i) {
+    size_type i = sz_;
+    size_type built = 0;
+    VECTOR_TRY {
+        for (; i > index; --i) {
             alloc_traits::construct(alloc_, arr_ + i + count - 1,
                 std::move_if_noexcept(arr_[i - 1]));
             alloc_traits::destroy(alloc_, arr_ + i - 1);
         }
-        for (size_type i = 0; i < count; ++i) {
-            alloc_traits::construct(alloc_, arr_ + index + i, *first++);
+        for (; built < count; ++built) {
+            alloc_traits::construct(alloc_, arr_ + index + built, *first++);
         }
         sz_ += count;
     }
-    catch (...) {
-        for (size_type i = index + count; i < sz_; ++i) {
-            alloc_traits::destroy(alloc_, arr_ + i);
+    VECTOR_CATCH(...) {
+        // [0, i) is still in place; the elements already moved up and the new ones are dropped
+        for (size_type j = index; j < index + built; ++j) {
+            alloc_traits::destroy(alloc_, arr_ + j);
         }
-        throw;
+        for (size_type j = i + count; j < sz_ + count; ++j) {
+            alloc_traits::destroy(alloc_, arr_ + j);
+        }
+        sz_ = i;
+        VECTOR_RETHROW;
     }
 
     return begin() + index;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert_impl(const_iterator pos, T&& value) {
-
-    if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+template<typename ...Args>
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::emplace_reallocate(size_type index, Args&& ...args) {
+    size_type newcap = round_capacity(cap_ > 0 ? cap_ * 2 : 1);
+    pointer newarr = allocate_buffer(newcap);
+    VECTOR_TRY {
+        alloc_traits::construct(alloc_, newarr + index, std::forward<Args>(args)...);
     }
-    if (pos == end()) {
-        push_back(value);
-        return --end();
+    VECTOR_CATCH(...) {
+        alloc_traits::deallocate(alloc_, newarr, newcap);
+        VECTOR_RETHROW;
     }
 
-    size_type index = pos - begin();
+    size_type i = 0;
+    VECTOR_TRY {
+        for (; i < sz_; ++i) {
+            alloc_traits::construct(alloc_, newarr + (i < index ? i : i + 1), std::move_if_noexcept(arr_[i]));
+        }
+    }
+    VECTOR_CATCH(...) {
+        for (size_type j = 0; j < i; ++j) {
+            alloc_traits::destroy(alloc_, newarr + (j < index ? j : j + 1));
+        }
+        alloc_traits::destroy(alloc_, newarr + index);
+        alloc_traits::deallocate(alloc_, newarr, newcap);
+        VECTOR_RETHROW;
+    }
 
-    if (sz_ == cap_) {
-        reserve(cap_ > 0 ? cap_ * 2 : 1);
+    for (size_type j = 0; j < sz_; ++j) {
+        alloc_traits::destroy(alloc_, arr_ + j);
     }
+    if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
 
-    try {
-        for (size_type i = sz_; i > index; --i) {
-            alloc_traits::construct(alloc_, arr_ + i,
-                std::move_if_noexcept(arr_[i - 1]));
-            alloc_traits::destroy(alloc_, arr_ + i - 1);
+    arr_ = newarr;
+    cap_ = newcap;
+    ++sz_;
+    profile_reallocation();
+    return begin() + index;
+}
+
+template<typename T, typename Alloc>
+template<typename ...Args>
+bool vector<T, Alloc>::args_in_buffer(const Args& ...args) const noexcept {
+    const void* first = arr_;
+    const void* last = arr_ + sz_;
+    return (... || (std::less_equal<const void*>()(first, std::addressof(args))
+        && std::less<const void*>()(std::addressof(args), last)));
+}
+
+template<typename T, typename Alloc>
+template<typename Pred>
+constexpr std::size_t vector<T, Alloc>::compact(Pred remove) {
+    size_type write = 0;
+    size_type read = 0;
+    bool relocating = false;
+    VECTOR_TRY {
+        for (; read < sz_; ++read) {
+            if (remove(read, arr_[read])) {
+                alloc_traits::destroy(alloc_, arr_ + read);
+                continue;
+            }
+            if (write != read) {
+                relocating = true;
+                alloc_traits::construct(alloc_, arr_ + write, std::move_if_noexcept(arr_[read]));
+                relocating = false;
+                alloc_traits::destroy(alloc_, arr_ + read);
+            }
+            ++write;
         }
-        alloc_traits::construct(alloc_, arr_ + index, std::forward<T>(value));
-        ++sz_;
     }
-    catch (...) {
-        for (size_type i = index + 1; i < sz_; ++i) {
+    VECTOR_CATCH(...) {
+        // [write, read) holds no elements anymore, the element at 'read' is still alive
+        size_type keep = read;
+        if (!relocating) {
+            // the predicate threw: the unvisited elements stay, as with std::erase_if
+            VECTOR_TRY {
+                for (; keep < sz_; ++keep, ++write) {
+                    if (write != keep) {
+                        alloc_traits::construct(alloc_, arr_ + write, std::move_if_noexcept(arr_[keep]));
+                        alloc_traits::destroy(alloc_, arr_ + keep);
+                    }
+                }
+            }
+            VECTOR_CATCH(...) {}
+        }
+        // a relocation threw: drop what could not be moved down to stay consistent
+        for (size_type i = keep; i < sz_; ++i) {
             alloc_traits::destroy(alloc_, arr_ + i);
         }
-        throw;
+        sz_ = write;
+        profile_size();
+        VECTOR_RETHROW;
+    }
+    size_type removed = sz_ - write;
+    sz_ = write;
+    maybe_shrink();
+    return removed;
+}
+
+template<typename T, typename Alloc>
+constexpr bool vector<T, Alloc>::in_buffer(const T* p) const noexcept {
+    if (std::is_constant_evaluated()) {
+        // relational comparison of unrelated pointers is not a constant expression
+        for (size_type i = 0; i < sz_; ++i) {
+            if (arr_ + i == p) return true;
+        }
+        return false;
     }
-    return begin() + index;
+    return std::less_equal<const T*>()(arr_, p) && std::less<const T*>()(p, arr_ + sz_);
 }
 
     // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
 
 template<typename T, typename Alloc>
 template<typename ...Args>
-inline void vector<T, Alloc>::emplace_back(Args && ...args) {
+constexpr void vector<T, Alloc>::emplace_back(Args && ...args) {
     if (sz_ == cap_) {
-        size_type newcap = cap_ > 0 ? cap_ * 2 : 1;
+        size_type newcap = round_capacity(cap_ > 0 ? cap_ * 2 : 1);
         size_type index = 0;
-        pointer newarr = alloc_traits::allocate(alloc_, newcap);
-        try {
+        pointer newarr = allocate_buffer(newcap);
+        VECTOR_TRY {
             alloc_traits::construct(alloc_, newarr + sz_, std::forward<Args>(args)...);
             for (; index < sz_; ++index) {
                 alloc_traits::construct(alloc_, newarr + index,
                     std::move_if_noexcept(arr_[index]));
             }
         }
-        catch (...) {
+        VECTOR_CATCH(...) {
             for (size_type new_index = 0; new_index < index; ++new_index) {
                 alloc_traits::destroy(alloc_, newarr + new_index);
             }
             alloc_traits::deallocate(alloc_, newarr, newcap);
-            throw;
+            VECTOR_RETHROW;
         }
 
         for (size_type index = 0; index < sz_; ++index) {
             alloc_traits::destroy(alloc_, arr_ + index);
         }
-        alloc_traits::deallocate(alloc_, arr_, cap_);
+        if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
 
         arr_ = newarr;
         cap_ = newcap;
         ++sz_;
+        profile_reallocation();
     }
 
     else {
-        try {
-            alloc_traits::construct(alloc_, arr_ + sz_,
-                std::forward<Args>(args)...);
-        }
-        catch (...) { throw; }
+        alloc_traits::construct(alloc_, arr_ + sz_, std::forward<Args>(args)...);
         ++sz_;
+        profile_size();
     }
 };
 
 template<typename T, typename Alloc> // push_back copying
-inline void vector<T, Alloc>::push_back(const value_type& value) {
+constexpr void vector<T, Alloc>::push_back(const value_type& value) {
     emplace_back(value);
 }
 
 template<typename T, typename Alloc> // push_back from moving
-inline void vector<T, Alloc>::push_back(value_type&& value) {
+constexpr void vector<T, Alloc>::push_back(value_type&& value) {
     emplace_back(std::move(value));
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, const T& value) {
+constexpr vector_errc vector<T, Alloc>::try_push_back(const value_type& value) {
+    return try_insert_at(sz_, value);
+}
 
-    return insert_impl(pos, value);
+template<typename T, typename Alloc>
+constexpr vector_errc vector<T, Alloc>::try_push_back(value_type&& value) {
+    return try_insert_at(sz_, std::move(value));
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, T&& value) {
+template<typename ...Args>
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::emplace(const_iterator pos, Args&& ...args) {
+    if (pos < cbegin() || pos > cend()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
+    }
+    const size_type index = pos - cbegin();
+    if (index == sz_) {
+        // emplace_back also constructs before relocating, so arguments aliasing elements stay valid
+        emplace_back(std::forward<Args>(args)...);
+        return begin() + index;
+    }
+    if (sz_ == cap_) {
+        return emplace_reallocate(index, std::forward<Args>(args)...);
+    }
 
-    return insert_impl(pos, std::move(value));
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+        if (!std::is_constant_evaluated() && !args_in_buffer(args...)) {
+            // open a gap at 'index' and construct straight into it; on failure close it again (strong guarantee)
+            for (size_type i = sz_; i > index; --i) {
+                alloc_traits::construct(alloc_, arr_ + i, std::move(arr_[i - 1]));
+                alloc_traits::destroy(alloc_, arr_ + i - 1);
+            }
+            VECTOR_TRY {
+                alloc_traits::construct(alloc_, arr_ + index, std::forward<Args>(args)...);
+            }
+            VECTOR_CATCH(...) {
+                for (size_type i = index; i < sz_; ++i) {
+                    alloc_traits::construct(alloc_, arr_ + i, std::move(arr_[i + 1]));
+                    alloc_traits::destroy(alloc_, arr_ + i + 1);
+                }
+                VECTOR_RETHROW;
+            }
+            ++sz_;
+            profile_size();
+            return begin() + index;
+        }
+    }
+
+    // the arguments may be elements that are about to shift (or moving may throw): build the value first.
+    // Every slot holds a live object throughout, so a throwing move leaves the vector valid (basic guarantee)
+    T value(std::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, arr_ + sz_, std::move_if_noexcept(arr_[sz_ - 1]));
+    ++sz_;
+    profile_size();
+    std::move_backward(arr_ + index, arr_ + sz_ - 2, arr_ + sz_ - 1);
+    arr_[index] = std::move(value);
+    return begin() + index;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, size_type count, const T& value) {
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, const T& value) {
+
+    return emplace(pos, value);
+}
+
+template<typename T, typename Alloc>
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, T&& value) {
+
+    return emplace(pos, std::move(value));
+}
+
+template<typename T, typename Alloc>
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, size_type count, const T& value) {
 
     size_type index = pos - begin();
 
@@ -815,14 +1412,14 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, s
     }
 
     if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     if (sz_ + count > cap_) {
         reserve(std::max(cap_ * 2, sz_ + count));
     }
 
-    try {
+    VECTOR_TRY {
         for (size_type i = sz_; i > index; --i) {
             alloc_traits::construct(alloc_, arr_ + i + count - 1,
                 std::move_if_noexcept(arr_[i - 1]));
@@ -832,23 +1429,23 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, s
             alloc_traits::construct(alloc_, arr_ + index + i, value);
         }
         sz_ += count;
+        profile_size();
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type i = index + count; i < sz_; ++i) {
             alloc_traits::destroy(alloc_, arr_ + i);
         }
-        throw;
+        VECTOR_RETHROW;
     }
 
     return begin() + index;
 }
 
 template<typename T, typename Alloc>
-template<class InputIt>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, InputIt first, InputIt last) {
+template<class InputIt> requires (!std::is_integral_v<InputIt>)
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, InputIt first, InputIt last) {
 
     using category1 = typename std::iterator_traits<InputIt>::iterator_category;
-    using category2 = typename std::iterator_traits<const_iterator>::iterator_category;
     if constexpr (std::is_same_v<category1, std::random_access_iterator_tag>) {
         return insert_dispatch(pos, first, last, 1);
     }
@@ -858,10 +1455,10 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, I
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, std::initializer_list<T> ilist) {
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, std::initializer_list<T> ilist) {
 
     if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     auto first = ilist.begin();
@@ -877,7 +1474,7 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, s
         reserve(std::max(cap_ * 2, sz_ + count));
     }
 
-    try {
+    VECTOR_TRY {
         for (size_type i = sz_; i > index; --i) {
             alloc_traits::construct(alloc_, arr_ + i + count - 1,
                 std::move_if_noexcept(arr_[i - 1]));
@@ -887,94 +1484,222 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos, s
             alloc_traits::construct(alloc_, arr_ + index + i, *first++);
         }
         sz_ += count;
+        profile_size();
     }
-    catch (...) {
+    VECTOR_CATCH(...) {
         for (size_type i = index + count; i < sz_; ++i) {
             alloc_traits::destroy(alloc_, arr_ + i);
         }
-        throw;
+        VECTOR_RETHROW;
     }
 
     return begin() + index;
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::pop_back() noexcept {
+template<std::random_access_iterator RandomIt>
+constexpr void vector<T, Alloc>::insert_many(std::span<const size_type> positions, RandomIt values) {
+    const size_type k = positions.size();
+    if (k == 0) {
+        return;
+    }
+    for (size_type i = 1; i < k; ++i) {
+        if (positions[i] < positions[i - 1]) {
+            VECTOR_THROW(std::out_of_range("indices are not sorted"));
+        }
+    }
+    if (positions.back() > sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    if constexpr (std::contiguous_iterator<RandomIt> && std::is_same_v<std::iter_value_t<RandomIt>, T>) {
+        const T* first = std::to_address(values);
+        if (in_buffer(first) || in_buffer(first + (k - 1))) {
+            // the values are our own elements, which are about to move
+            const vector copy(first, first + k);
+            insert_many(positions, copy.data());
+            return;
+        }
+    }
+
+    const size_type newsize = sz_ + k;
+    if (newsize > cap_) {
+        // front to back into the new buffer, the old one stays intact until the end (strong guarantee)
+        size_type newcap = round_capacity(std::max(newsize, cap_ * 2));
+        pointer newarr = allocate_buffer(newcap);
+        size_type built = 0;
+        VECTOR_TRY {
+            size_type src = 0;
+            for (size_type j = 0; j < k; ++j) {
+                for (; src < positions[j]; ++src, ++built) {
+                    alloc_traits::construct(alloc_, newarr + built, std::move_if_noexcept(arr_[src]));
+                }
+                alloc_traits::construct(alloc_, newarr + built, values[j]);
+                ++built;
+            }
+            for (; src < sz_; ++src, ++built) {
+                alloc_traits::construct(alloc_, newarr + built, std::move_if_noexcept(arr_[src]));
+            }
+        }
+        VECTOR_CATCH(...) {
+            for (size_type i = 0; i < built; ++i) {
+                alloc_traits::destroy(alloc_, newarr + i);
+            }
+            alloc_traits::deallocate(alloc_, newarr, newcap);
+            VECTOR_RETHROW;
+        }
+
+        for (size_type i = 0; i < sz_; ++i) {
+            alloc_traits::destroy(alloc_, arr_ + i);
+        }
+        if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+        arr_ = newarr;
+        cap_ = newcap;
+        sz_ = newsize;
+        profile_reallocation();
+        return;
+    }
+
+    /* In place, back to front: each segment between two positions moves up once by the number of values still
+    * to its left. Slots past the old end are constructed, the others assigned, so if an element throws,
+    * [0, size()) still holds live objects (basic guarantee) and only the constructed tail is destroyed */
+    size_type dest = newsize;
+    size_type src = sz_;
+    size_type constructed = newsize;
+    auto put = [&](size_type slot, auto&& value) {
+        if (slot >= sz_) {
+            alloc_traits::construct(alloc_, arr_ + slot, std::forward<decltype(value)>(value));
+            constructed = slot;
+        }
+        else {
+            arr_[slot] = std::forward<decltype(value)>(value);
+        }
+    };
+    VECTOR_TRY {
+        for (size_type j = k; j > 0; --j) {
+            while (src > positions[j - 1]) {
+                --src;
+                --dest;
+                put(dest, std::move_if_noexcept(arr_[src]));
+            }
+            --dest;
+            put(dest, values[j - 1]);
+        }
+    }
+    VECTOR_CATCH(...) {
+        for (size_type i = constructed; i < newsize; ++i) {
+            alloc_traits::destroy(alloc_, arr_ + i);
+        }
+        VECTOR_RETHROW;
+    }
+    sz_ = newsize;
+    profile_size();
+}
+
+template<typename T, typename Alloc>
+constexpr vector_errc vector<T, Alloc>::try_insert(const_iterator pos, const T& value) {
+    if (pos < cbegin() || pos > cend()) {
+        return vector_errc::out_of_range;
+    }
+    return try_insert_at(pos - cbegin(), value);
+}
+
+template<typename T, typename Alloc>
+constexpr vector_errc vector<T, Alloc>::try_insert(const_iterator pos, T&& value) {
+    if (pos < cbegin() || pos > cend()) {
+        return vector_errc::out_of_range;
+    }
+    return try_insert_at(pos - cbegin(), std::move(value));
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::pop_back() noexcept {
     if (sz_ > 0) {
         --sz_;
         alloc_traits::destroy(alloc_, arr_ + sz_);
+        maybe_shrink();
     }
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::swap(vector& other) noexcept {
+constexpr void vector<T, Alloc>::swap(vector& other) noexcept {
     std::swap(sz_, other.sz_);
     std::swap(cap_, other.cap_);
     std::swap(arr_, other.arr_);
     std::swap(alloc_, other.alloc_);
+    std::swap(shrink_divisor_, other.shrink_divisor_);
+    profile_sizes();
+    other.profile_sizes();
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::resize(size_type count) {
+constexpr void vector<T, Alloc>::resize(size_type count) {
     if (sz_ > count) {
         for (size_type i = count; i < sz_; ++i) {
             alloc_traits::destroy(alloc_, arr_ + i);
         }
+        sz_ = count;
+        maybe_shrink();
+        return;
     }
     else if (sz_ < count) {
         if (count > cap_) {
             reserve(count);
         }
         size_type i = sz_;
-        try {
+        VECTOR_TRY {
             for (; i < count; ++i) {
                 alloc_traits::construct(alloc_, arr_ + i, T());
             }
         }
-        catch (...) {
+        VECTOR_CATCH(...) {
             for (size_type new_i = sz_; new_i < i; ++new_i) {
                 alloc_traits::destroy(alloc_, arr_ + new_i);
             }
-            throw;
+            VECTOR_RETHROW;
         }
     }
 
     sz_ = count;
+    profile_size();
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::resize(size_type count, const value_type& value) {
+constexpr void vector<T, Alloc>::resize(size_type count, const value_type& value) {
     if (sz_ > count) {
         for (size_type i = count; i < sz_; ++i) {
             alloc_traits::destroy(alloc_, arr_ + i);
         }
+        sz_ = count;
+        maybe_shrink();
+        return;
     }
     else if (sz_ < count) {
         if (count > cap_) {
             reserve(count);
         }
         size_type i = sz_;
-        try {
+        VECTOR_TRY {
             for (; i < count; ++i) {
                 alloc_traits::construct(alloc_, arr_ + i, value);
             }
         }
-        catch (...) {
+        VECTOR_CATCH(...) {
             for (size_type new_i = sz_; new_i < i; ++new_i) {
                 alloc_traits::destroy(alloc_, arr_ + new_i);
             }
-            throw;
+            VECTOR_RETHROW;
         }
     }
 
     sz_ = count;
+    profile_size();
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator pos) {
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator pos) {
 
-    if (pos < begin() || pos > end()) {
-        throw std::out_of_range("Iterator out of range");
+    if (pos < begin() || pos >= end()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     size_type index = pos - begin();
@@ -986,15 +1711,16 @@ inline vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator pos) {
     }
 
     --sz_;
+    maybe_shrink();
 
     return begin() + index;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::const_iterator vector<T, Alloc>::erase(const_iterator pos) {
+constexpr vector<T, Alloc>::const_iterator vector<T, Alloc>::erase(const_iterator pos) {
 
-    if (pos < cbegin() || pos > cend()) {
-        throw std::out_of_range("Iterator out of range");
+    if (pos < cbegin() || pos >= cend()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
     size_type index = pos - cbegin();
@@ -1006,172 +1732,637 @@ inline vector<T, Alloc>::const_iterator vector<T, Alloc>::erase(const_iterator p
     }
 
     --sz_;
+    maybe_shrink();
 
     return cbegin() + index;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator first, iterator last)
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator first, iterator last)
 {
     if (first < begin() || last > end() || first > end()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
-    size_type index_first = first - begin();
-    size_type index_last = last - begin();
-    size_type count = index_last - index_first;
+    const size_type index_first = first - begin();
+    const size_type index_last = last - begin();
+    const size_type count = index_last - index_first;
 
     for (size_type i = index_first; i < index_last; ++i) {
         alloc_traits::destroy(alloc_, arr_ + i);
     }
 
-    for (size_type i = index_last; i < sz_; ++i, ++index_first) {
-        alloc_traits::construct(alloc_, arr_ + index_first, std::move_if_noexcept(arr_[i]));
+    for (size_type i = index_last, dest = index_first; i < sz_; ++i, ++dest) {
+        alloc_traits::construct(alloc_, arr_ + dest, std::move_if_noexcept(arr_[i]));
         alloc_traits::destroy(alloc_, arr_ + i);
     }
 
     sz_ -= count;
+    maybe_shrink();
 
     return begin() + index_first;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::const_iterator vector<T, Alloc>::erase(const_iterator first, const_iterator last)
+constexpr vector<T, Alloc>::const_iterator vector<T, Alloc>::erase(const_iterator first, const_iterator last)
 {
     if (first < cbegin() || last > cend() || first > cend()) {
-        throw std::out_of_range("Iterator out of range");
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
 
-    size_type index_first = first - cbegin();
-    size_type index_last = last - cbegin();
-    size_type count = index_last - index_first;
+    const size_type index_first = first - cbegin();
+    const size_type index_last = last - cbegin();
+    const size_type count = index_last - index_first;
 
     for (size_type i = index_first; i < index_last; ++i) {
         alloc_traits::destroy(alloc_, arr_ + i);
     }
 
-    for (size_type i = index_last; i < sz_; ++i, ++index_first) {
-        alloc_traits::construct(alloc_, arr_ + index_first, std::move_if_noexcept(arr_[i]));
+    for (size_type i = index_last, dest = index_first; i < sz_; ++i, ++dest) {
+        alloc_traits::construct(alloc_, arr_ + dest, std::move_if_noexcept(arr_[i]));
         alloc_traits::destroy(alloc_, arr_ + i);
     }
 
     sz_ -= count;
+    maybe_shrink();
 
     return cbegin() + index_first;
 }
 
-    // +++++++++++++++++++ MEMBER FUNCTIONS +++++++++++++++++++
+template<typename T, typename Alloc>
+template<typename Pred>
+constexpr std::size_t vector<T, Alloc>::erase_if(Pred pred) {
+    return compact([&pred](size_type, const T& value) { return static_cast<bool>(pred(value)); });
+}
 
-// copy assignment
-template<typename T, typename Alloc> 
-inline vector<T, Alloc>& vector<T, Alloc>::operator=(const vector& other) {
-    Alloc newalloc = alloc_traits::propagate_on_container_copy_assignment::value ?
-        other.alloc_ : alloc_;
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::remove_values(const T& value) {
+    if (in_buffer(std::addressof(value))) {
+        // 'value' would be destroyed or overwritten during the pass
+        const T copy(value);
+        return compact([&copy](size_type, const T& element) { return element == copy; });
+    }
+    return compact([&value](size_type, const T& element) { return element == value; });
+}
 
-    if (this == &other) return *this;
-    size_type index = 0;
-    pointer newarr = alloc_traits::allocate(newalloc, other.cap_);
-    try {
-        for (; index < other.sz_; ++index) {
-            alloc_traits::construct(newalloc, newarr + index, other[index]);
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::erase_indices(std::span<const size_type> indices) {
+    if (indices.empty()) {
+        return 0;
+    }
+    for (size_type i = 1; i < indices.size(); ++i) {
+        if (indices[i] < indices[i - 1]) {
+            VECTOR_THROW(std::out_of_range("indices are not sorted"));
         }
     }
-    catch (...) {
-        for (size_type new_index = 0; new_index < index; ++new_index) {
-            alloc_traits::destroy(newalloc, newarr + new_index);
+    if (indices.back() >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+
+    size_type next = 0;
+    return compact([&](size_type index, const T&) {
+        if (next == indices.size() || indices[next] != index) {
+            return false;
         }
-        alloc_traits::deallocate(newalloc, newarr, other.cap_);
-        throw;
+        while (next < indices.size() && indices[next] == index) {
+            ++next;
+        }
+        return true;
+    });
+}
+
+template<typename T, typename Alloc>
+constexpr vector<T, Alloc>::iterator vector<T, Alloc>::erase_unordered(const_iterator pos) {
+
+    if (pos < cbegin() || pos >= cend()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
     }
-    for (size_type i = 0; i < sz_; ++i) {
-        alloc_traits::destroy(alloc_, arr_ + i);
+
+    size_type index = pos - cbegin();
+    if (index != sz_ - 1) {
+        arr_[index] = std::move(arr_[sz_ - 1]);
+    }
+    pop_back();
+
+    return begin() + index;
+}
+
+template<typename T, typename Alloc>
+constexpr std::size_t vector<T, Alloc>::erase_unordered(std::span<const size_type> indices) {
+    if (indices.empty()) {
+        return 0;
+    }
+    for (size_type i = 1; i < indices.size(); ++i) {
+        if (indices[i] < indices[i - 1]) {
+            VECTOR_THROW(std::out_of_range("indices are not sorted"));
+        }
+    }
+    if (indices.back() >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+
+    // from the back: the last element is never one that is still waiting to be removed
+    size_type removed = 0;
+    for (size_type i = indices.size(); i > 0; --i) {
+        size_type index = indices[i - 1];
+        if (i < indices.size() && index == indices[i]) {
+            continue;
+        }
+        if (index != sz_ - 1) {
+            arr_[index] = std::move(arr_[sz_ - 1]);
+        }
+        --sz_;
+        alloc_traits::destroy(alloc_, arr_ + sz_);
+        ++removed;
+    }
+    // shrink once for the whole batch rather than after every removal
+    maybe_shrink();
+    return removed;
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::gather(std::span<const size_type> indices, std::span<T> out, size_type distance) const {
+    check_batch(indices, out.size());
+    const size_type n = indices.size();
+    size_type i = 0;
+    for (; i + distance < n; ++i) {
+        prefetch<false>(arr_ + indices[i + distance]);
+        out[i] = arr_[indices[i]];
+    }
+    for (; i < n; ++i) {
+        out[i] = arr_[indices[i]];
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::scatter(std::span<const size_type> indices, std::span<const T> values, size_type distance) {
+    check_batch(indices, values.size());
+    const size_type n = indices.size();
+    size_type i = 0;
+    for (; i + distance < n; ++i) {
+        prefetch<true>(arr_ + indices[i + distance]);
+        arr_[indices[i]] = values[i];
+    }
+    for (; i < n; ++i) {
+        arr_[indices[i]] = values[i];
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::check_batch(std::span<const size_type> indices, size_type count) const {
+    if (count < indices.size()) {
+        VECTOR_THROW(std::invalid_argument("fewer elements than indices"));
+    }
+    // a sequential pass over the indices is cheap next to the random accesses it protects
+    size_type largest = 0;
+    for (size_type index : indices) {
+        largest = std::max(largest, index);
+    }
+    if (!indices.empty() && largest >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+}
+
+template<typename T, typename Alloc>
+template<bool Write>
+constexpr void vector<T, Alloc>::prefetch(const T* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    if (!std::is_constant_evaluated()) {
+        __builtin_prefetch(p, Write ? 1 : 0);
+    }
+#else
+    (void)p;
+#endif
+}
+
+template<typename T, typename Alloc>
+void vector<T, Alloc>::radix_sort(unsigned threads) requires radix_key<T> {
+    radix_sort_by_key([](const T& value) noexcept -> const T& { return value; }, threads);
+}
+
+template<typename T, typename Alloc>
+template<typename KeyFn> requires std::is_nothrow_invocable_v<KeyFn&, const T&>
+void vector<T, Alloc>::radix_sort_by_key(KeyFn key_fn, unsigned threads) {
+    using key_type = std::remove_cvref_t<std::invoke_result_t<KeyFn&, const T&>>;
+    static_assert(radix_key<key_type>, "radix_sort_by_key: key_fn must return an integral, floating-point, pair or tuple key");
+    using traits = radix_key_traits<key_type>;
+
+    if (sz_ < 2) {
+        return;
+    }
+
+    auto key_of = [&key_fn](const T& value) noexcept -> decltype(auto) { return std::invoke(key_fn, value); };
+
+    auto sort_by_comparison = [this, &key_of] {
+        std::stable_sort(arr_, arr_ + sz_, [&key_of](const T& lhs, const T& rhs) {
+            const auto& lhs_key = key_of(lhs);
+            const auto& rhs_key = key_of(rhs);
+            for (size_type byte = traits::bytes; byte > 0; --byte) {
+                unsigned lhs_digit = traits::digit(lhs_key, byte - 1);
+                unsigned rhs_digit = traits::digit(rhs_key, byte - 1);
+                if (lhs_digit != rhs_digit) {
+                    return lhs_digit < rhs_digit;
+                }
+            }
+            return false;
+        });
+    };
+
+    if (sz_ <= radix_sort_cutoff || !std::is_nothrow_move_constructible_v<T>) {
+        // moving elements between two buffers is only safe with a nothrow move; compare digit by digit instead
+        sort_by_comparison();
+        return;
+    }
+
+    size_type workers = 1;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        size_type available = threads != 0 ? threads : std::thread::hardware_concurrency();
+        workers = std::max<size_type>(1, std::min(available, sz_ / radix_min_chunk));
+    }
+
+    // without memory for the scratch buffer or the histograms, stable_sort still works (in place if it has to)
+    size_type scratch_cap = cap_;
+    T* scratch = nullptr;
+    VECTOR_TRY {
+        scratch = try_allocate_buffer(scratch_cap);
+    }
+    VECTOR_CATCH(...) {}
+    if (scratch == nullptr) {
+        sort_by_comparison();
+        return;
+    }
+    std::unique_ptr<size_type[]> counts(new (std::nothrow) size_type[workers * traits::bytes * 256]());
+    if (counts == nullptr) {
+        alloc_traits::deallocate(alloc_, scratch, scratch_cap);
+        sort_by_comparison();
+        return;
+    }
+    radix_passes(key_of, scratch, scratch_cap, counts.get(), workers);
+}
+
+template<typename T, typename Alloc>
+template<typename KeyOf>
+void vector<T, Alloc>::radix_passes(KeyOf& key_of, T* scratch, size_type scratch_cap, size_type* counts, size_type workers) noexcept {
+    using traits = radix_key_traits<std::remove_cvref_t<decltype(key_of(*arr_))>>;
+    constexpr size_type bytes = traits::bytes;
+    const size_type chunk = (sz_ + workers - 1) / workers;
+
+    // counts holds one 256-entry histogram per worker and key byte
+    auto histogram = [counts](size_type worker, size_type byte) { return counts + (worker * bytes + byte) * 256; };
+
+    // a single read pass builds the histograms of every byte
+    auto count_all = [&](size_type worker) {
+        const size_type last = std::min(sz_, (worker + 1) * chunk);
+        for (size_type i = worker * chunk; i < last; ++i) {
+            const auto& key = key_of(arr_[i]);
+            for (size_type byte = 0; byte < bytes; ++byte) {
+                ++histogram(worker, byte)[traits::digit(key, byte)];
+            }
+        }
+    };
+    run_workers(workers, count_all);
+
+    T* src = arr_;
+    T* dst = scratch;
+    bool moved = false;
+    for (size_type byte = 0; byte < bytes; ++byte) {
+        size_type total[256] = {};
+        for (size_type worker = 0; worker < workers; ++worker) {
+            for (size_type digit = 0; digit < 256; ++digit) {
+                total[digit] += histogram(worker, byte)[digit];
+            }
+        }
+        if (std::find(total, total + 256, sz_) != total + 256) {
+            continue;
+        }
+
+        // the totals do not depend on the order, but each worker's share does once elements have moved
+        if (moved && workers > 1) {
+            auto count_byte = [&](size_type worker) {
+                size_type* hist = histogram(worker, byte);
+                std::fill(hist, hist + 256, 0);
+                const size_type last = std::min(sz_, (worker + 1) * chunk);
+                for (size_type i = worker * chunk; i < last; ++i) {
+                    ++hist[traits::digit(key_of(src[i]), byte)];
+                }
+            };
+            run_workers(workers, count_byte);
+        }
+
+        // turn the counts into output offsets: by digit, then by worker, which keeps the sort stable
+        size_type offset = 0;
+        for (size_type digit = 0; digit < 256; ++digit) {
+            for (size_type worker = 0; worker < workers; ++worker) {
+                size_type count = histogram(worker, byte)[digit];
+                histogram(worker, byte)[digit] = offset;
+                offset += count;
+            }
+        }
+
+        auto scatter = [&](size_type worker) {
+            size_type* next = histogram(worker, byte);
+            const size_type last = std::min(sz_, (worker + 1) * chunk);
+            for (size_type i = worker * chunk; i < last; ++i) {
+                T* slot = dst + next[traits::digit(key_of(src[i]), byte)]++;
+                alloc_traits::construct(alloc_, slot, std::move(src[i]));
+                alloc_traits::destroy(alloc_, src + i);
+            }
+        };
+        run_workers(workers, scatter);
+        std::swap(src, dst);
+        moved = true;
+    }
+
+    // after an odd number of passes the elements live in the scratch buffer, which then becomes arr_
+    if (src == arr_) {
+        alloc_traits::deallocate(alloc_, scratch, scratch_cap);
+        return;
     }
     alloc_traits::deallocate(alloc_, arr_, cap_);
+    arr_ = src;
+    cap_ = scratch_cap;
+    profile_reallocation();
+}
 
-    alloc_ = newalloc;
-    arr_ = newarr;
-    sz_ = other.sz_;
-    cap_ = other.cap_;
+template<typename T, typename Alloc>
+template<typename Fn>
+void vector<T, Alloc>::run_workers(size_type workers, Fn& fn) noexcept {
+    std::unique_ptr<std::thread[]> pool;
+    size_type started = 0;
+    if (workers > 1) {
+        VECTOR_TRY {
+            pool.reset(new std::thread[workers - 1]);
+            for (; started < workers - 1; ++started) {
+                pool[started] = std::thread(std::ref(fn), started + 1);
+            }
+        }
+        VECTOR_CATCH(...) {
+            // the shares that did not get a thread run on this one
+        }
+    }
+    for (size_type worker = started + 1; worker < workers; ++worker) {
+        fn(worker);
+    }
+    fn(0);
+    for (size_type i = 0; i < started; ++i) {
+        pool[i].join();
+    }
+}
+
+    // +++++++++++++++++++ MEMBER FUNCTIONS +++++++++++++++++++
+
+// copy assignment. Reuses the current buffer when it is large enough
+template<typename T, typename Alloc> 
+constexpr vector<T, Alloc>& vector<T, Alloc>::operator=(const vector& other) {
+    if (this == &other) return *this;
+
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+        if (!alloc_traits::is_always_equal::value && alloc_ != other.alloc_) {
+            // the current buffer must be released by the allocator that obtained it
+            clear();
+            if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+            arr_ = nullptr;
+            cap_ = 0;
+        }
+        alloc_ = other.alloc_;
+    }
+    assign_counted(other.arr_, other.sz_);
+    shrink_divisor_ = other.shrink_divisor_;
 
     return *this;
 }
 
 // move assignment
 template<typename T, typename Alloc> 
-inline vector<T, Alloc>& vector<T, Alloc>::operator=(vector&& other) noexcept {
+constexpr vector<T, Alloc>& vector<T, Alloc>::operator=(vector&& other)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
     if (this == &other) return *this;
 
-    if (arr_ != nullptr)alloc_traits::deallocate(alloc_, arr_, cap_);
-    Alloc newalloc = alloc_traits::propagate_on_container_move_assignment::value ?
-        other.alloc_ : alloc_;
-    alloc_ = newalloc;
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value && !alloc_traits::is_always_equal::value) {
+        if (alloc_ != other.alloc_) {
+            // the buffer of 'other' must be released by its own allocator, so it cannot be taken over
+            assign_counted(std::make_move_iterator(other.arr_), other.sz_);
+            shrink_divisor_ = other.shrink_divisor_;
+            other.clear();
+            return *this;
+        }
+    }
+
+    clear();
+    if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        alloc_ = std::move(other.alloc_);
+    }
     arr_ = other.arr_; other.arr_ = nullptr;
     sz_ = other.sz_;   other.sz_ = 0;
-    cap_ = other.cap_; 
+    cap_ = other.cap_; other.cap_ = 0;
+    shrink_divisor_ = other.shrink_divisor_;
+    profile_sizes();
+    other.profile_sizes();
 
     return *this;
 }
 
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::allocator_type vector<T, Alloc>::get_allocator() const noexcept {
+constexpr vector<T, Alloc>::allocator_type vector<T, Alloc>::get_allocator() const noexcept {
     return alloc_;
 }
 
 template<typename T, typename Alloc>
-inline void vector<T, Alloc>::assign(size_type count, const T& value) {
-
-    if (count <= 0) {
-        if (arr_ != nullptr) {
-            clear();
-        }
-        return;
-    }
+constexpr void vector<T, Alloc>::assign(size_type count, const T& value) {
 
     if (count > cap_) {
-        pointer newarr = alloc_traits::allocate(alloc_, count);
-        try {
-            for (size_type i = 0; i < count; ++i) {
-                alloc_traits::construct(alloc_, newarr + i, value);
+        size_type newcap = round_capacity(count);
+        pointer newarr = allocate_buffer(newcap);
+        size_type index = 0;
+        VECTOR_TRY {
+            for (; index < count; ++index) {
+                alloc_traits::construct(alloc_, newarr + index, value);
             }
         }
-        catch (...) {
-            alloc_traits::deallocate(alloc_, newarr, count);
-            throw;
+        VECTOR_CATCH(...) {
+            for (size_type new_index = 0; new_index < index; ++new_index) {
+                alloc_traits::destroy(alloc_, newarr + new_index);
+            }
+            alloc_traits::deallocate(alloc_, newarr, newcap);
+            VECTOR_RETHROW;
         }
 
-        if (arr_ != nullptr) {
-            clear();
-            alloc_traits::deallocate(alloc_, arr_, cap_);
-        }
+        clear();
+        if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
 
         arr_ = newarr;
-        cap_ = count;
+        cap_ = newcap;
+        sz_ = count;
+        profile_reallocation();
+        return;
+    }
+
+    // 'value' may be one of the elements: it is only destroyed, with the tail, after its last use
+    const size_type common = std::min(sz_, count);
+    for (size_type i = 0; i < common; ++i) {
+        arr_[i] = value;
+    }
+    for (; sz_ < count; ++sz_) {
+        alloc_traits::construct(alloc_, arr_ + sz_, value);
     }
+    for (size_type i = count; i < sz_; ++i) {
+        alloc_traits::destroy(alloc_, arr_ + i);
+    }
+    sz_ = count;
+    profile_size();
+}
 
+template<typename T, typename Alloc>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+constexpr void vector<T, Alloc>::assign(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+        assign_counted(first, static_cast<size_type>(std::distance(first, last)));
+    }
     else {
-        clear();
+        // single pass: overwrite the live elements, then append or drop the rest
         size_type index = 0;
-        try {
-            for (; index < count; ++index) {
-                alloc_traits::construct(alloc_, arr_ + index, value);
+        for (; index < sz_ && first != last; ++index, ++first) {
+            arr_[index] = *first;
+        }
+        if (first == last) {
+            for (size_type i = index; i < sz_; ++i) {
+                alloc_traits::destroy(alloc_, arr_ + i);
             }
+            sz_ = index;
+            profile_size();
         }
-        catch (...) {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::assign(std::initializer_list<T> ilist) {
+    assign_counted(ilist.begin(), ilist.size());
+}
+
+template<typename T, typename Alloc>
+template<typename ForwardIt>
+constexpr void vector<T, Alloc>::assign_counted(ForwardIt first, size_type count) {
+
+    if (count > cap_) {
+        // a new buffer is filled before the old one is released: strong guarantee
+        size_type newcap = round_capacity(count);
+        pointer newarr = allocate_buffer(newcap);
+        size_type index = 0;
+        VECTOR_TRY {
+            for (; index < count; ++index, ++first) {
+                alloc_traits::construct(alloc_, newarr + index, *first);
+            }
+        }
+        VECTOR_CATCH(...) {
             for (size_type new_index = 0; new_index < index; ++new_index) {
-                alloc_traits::destroy(alloc_, arr_ + new_index);
+                alloc_traits::destroy(alloc_, newarr + new_index);
             }
-            throw;
+            alloc_traits::deallocate(alloc_, newarr, newcap);
+            VECTOR_RETHROW;
         }
+
+        clear();
+        if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
+
+        arr_ = newarr;
+        cap_ = newcap;
+        sz_ = count;
+        profile_reallocation();
+        return;
     }
 
+    // in place: copy-assign over the live elements, construct or destroy only the difference (basic guarantee)
+    const size_type common = std::min(sz_, count);
+    for (size_type i = 0; i < common; ++i, ++first) {
+        arr_[i] = *first;
+    }
+    for (; sz_ < count; ++sz_, ++first) {
+        alloc_traits::construct(alloc_, arr_ + sz_, *first);
+    }
+    for (size_type i = count; i < sz_; ++i) {
+        alloc_traits::destroy(alloc_, arr_ + i);
+    }
     sz_ = count;
+    profile_size();
+}
+
+    // +++++++++++++++++++ HEAP PROFILING +++++++++++++++++++
+
+#ifdef VECTOR_HEAP_PROFILE
+template<typename T, typename Alloc>
+inline void vector<T, Alloc>::set_profile_tag(const char* tag) {
+    profile_unregister();
+    profile_size();
+    vector_heap_profiler::instance().register_instance(this, tag, typeid(T).name(), &profile_live_bytes_, cap_ * sizeof(T));
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_register(const std::source_location& site) noexcept {
+    if (std::is_constant_evaluated()) return;
+    profile_size();
+    VECTOR_TRY {
+        vector_heap_profiler::instance().register_instance(this, site, typeid(T).name(), &profile_live_bytes_, cap_ * sizeof(T));
+    }
+    VECTOR_CATCH(...) {} // profiling must never change the behaviour of the container
+}
+#else
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_register() noexcept {}
+#endif
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_unregister() noexcept {
+#ifdef VECTOR_HEAP_PROFILE
+    if (std::is_constant_evaluated()) return;
+    VECTOR_TRY {
+        vector_heap_profiler::instance().unregister_instance(this);
+    }
+    VECTOR_CATCH(...) {}
+#endif
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_reallocation() noexcept {
+#ifdef VECTOR_HEAP_PROFILE
+    if (std::is_constant_evaluated()) return;
+    profile_size();
+    VECTOR_TRY {
+        vector_heap_profiler::instance().record_reallocation(this, cap_ * sizeof(T));
+    }
+    VECTOR_CATCH(...) {}
+#endif
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_sizes() noexcept {
+#ifdef VECTOR_HEAP_PROFILE
+    if (std::is_constant_evaluated()) return;
+    profile_size();
+    VECTOR_TRY {
+        vector_heap_profiler::instance().record_capacity(this, cap_ * sizeof(T));
+    }
+    VECTOR_CATCH(...) {}
+#endif
+}
+
+template<typename T, typename Alloc>
+constexpr void vector<T, Alloc>::profile_size() noexcept {
+#ifdef VECTOR_HEAP_PROFILE
+    if (std::is_constant_evaluated()) return;
+    profile_live_bytes_.store(sz_ * sizeof(T), std::memory_order_relaxed);
+#endif
 }
 
     // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
 
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator==(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator==(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return (lhs.size() == rhs.size()
         && std::equal(lhs.begin(), lhs.end(), rhs.begin()));
 }
@@ -1179,13 +2370,13 @@ inline bool operator==(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs)
 // based on operator==
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator!=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator!=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(lhs == rhs);
 }
 
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator<(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator<(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     if (lhs.size() != rhs.size()) {
         return lhs.size() < rhs.size();
     }
@@ -1196,27 +2387,38 @@ inline bool operator<(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs)
 // based on operator<
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator>(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator>(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return (rhs < lhs);
 }
 
 // based on operator<
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator<=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator<=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(rhs < lhs);
 }
 
 // based on operator<
 template<typename T, typename Alloc>
 [[nodiscard]]
-inline bool operator>=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
+constexpr bool operator>=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(lhs < rhs);
 }
 
     // DTOR
 template<typename T, typename Alloc>
-inline vector<T, Alloc>::~vector() noexcept {
+constexpr vector<T, Alloc>::~vector() noexcept {
+    profile_unregister();
     clear();
     if (arr_ != nullptr) alloc_traits::deallocate(alloc_, arr_, cap_);
 }
+
+// iterators and vector itself model the C++20 contiguous concepts, which standard and ranges algorithms check
+static_assert(std::contiguous_iterator<vector<int>::iterator>);
+static_assert(std::contiguous_iterator<vector<int>::const_iterator>);
+static_assert(std::sized_sentinel_for<vector<int>::const_iterator, vector<int>::iterator>);
+static_assert(std::ranges::contiguous_range<vector<int>> && std::ranges::sized_range<vector<int>>);
+static_assert(std::ranges::contiguous_range<const vector<int>>);
+
+// bit-packed vector<bool, Alloc>
+#include "vector_bool.h"
@@ -0,0 +1,763 @@
+/*
+ * vector<bool, Alloc> - bit-packed specialization of vector.
+ *
+ * Stores one bit per element in 64-bit words (allocated through Alloc rebound to the word type),
+ * so element access goes through a proxy reference. Bits past size() in the last word are kept
+ * zero, which lets count(), find_first/find_next, the comparisons and the bitwise operators work
+ * a word at a time; the bitwise loops are plain word loops the compiler vectorizes. insert and
+ * erase shift the bits behind the position up to a word at a time as well.
+ *
+ * Included by vector.h; there is no need to include it directly.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+#include "vector.h"
+
+template <typename Alloc>
+class vector<bool, Alloc> {
+public:
+    using word_type = std::uint64_t;
+
+    static constexpr std::size_t bits_per_word = 64;
+
+    // CLASS bit_reference. Proxy for a single bit
+
+    class bit_reference {
+    public:
+        constexpr bit_reference(word_type* word, std::size_t bit) noexcept : word_(word), mask_(word_type(1) << bit) {}
+        constexpr bit_reference(const bit_reference&) = default;
+
+        constexpr operator bool() const noexcept { return (*word_ & mask_) != 0; }
+
+        constexpr bit_reference& operator=(bool value) noexcept {
+            *word_ = value ? (*word_ | mask_) : (*word_ & ~mask_);
+            return *this;
+        }
+
+        constexpr bit_reference& operator=(const bit_reference& other) noexcept { return *this = static_cast<bool>(other); }
+
+        constexpr bool operator~() const noexcept { return !static_cast<bool>(*this); }
+
+        constexpr void flip() noexcept { *word_ ^= mask_; }
+
+        // swaps the referenced bits, so that std::swap-based algorithms work through the proxy
+        friend constexpr void swap(bit_reference lhs, bit_reference rhs) noexcept {
+            bool value = lhs;
+            lhs = static_cast<bool>(rhs);
+            rhs = value;
+        }
+
+    private:
+        word_type* word_;
+        word_type mask_;
+    };
+
+private:
+
+    // CLASS base_iterator. A word pointer and a bit index
+
+    template <bool IsConst>
+    class base_iterator {
+    public:
+        using word_pointer = std::conditional_t<IsConst, const word_type*, word_type*>;
+        using reference = std::conditional_t<IsConst, bool, bit_reference>;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+
+        constexpr base_iterator() = default;
+        constexpr base_iterator(word_pointer words, std::size_t index) : words_(words), index_(index) {}
+
+        constexpr operator base_iterator<true>() const { return base_iterator<true>(words_, index_); }
+
+        constexpr reference operator*() const {
+            if constexpr (IsConst) {
+                return ((words_[index_ / bits_per_word] >> (index_ % bits_per_word)) & 1) != 0;
+            }
+            else {
+                return bit_reference(words_ + index_ / bits_per_word, index_ % bits_per_word);
+            }
+        }
+
+        constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+        constexpr base_iterator& operator++() { ++index_; return *this; }
+        constexpr base_iterator operator++(int) { base_iterator copy = *this; ++index_; return copy; }
+        constexpr base_iterator& operator--() { --index_; return *this; }
+        constexpr base_iterator operator--(int) { base_iterator copy = *this; --index_; return copy; }
+        constexpr base_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        constexpr base_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        constexpr base_iterator operator+(difference_type n) const { return base_iterator(words_, index_ + n); }
+        constexpr base_iterator operator-(difference_type n) const { return base_iterator(words_, index_ - n); }
+        friend constexpr base_iterator operator+(difference_type n, const base_iterator& it) { return it + n; }
+        constexpr difference_type operator-(const base_iterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        constexpr bool operator==(const base_iterator& other) const { return index_ == other.index_; }
+        constexpr bool operator!=(const base_iterator& other) const { return index_ != other.index_; }
+        constexpr bool operator<(const base_iterator& other) const { return index_ < other.index_; }
+        constexpr bool operator>(const base_iterator& other) const { return index_ > other.index_; }
+        constexpr bool operator<=(const base_iterator& other) const { return index_ <= other.index_; }
+        constexpr bool operator>=(const base_iterator& other) const { return index_ >= other.index_; }
+
+    private:
+        word_pointer words_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    using word_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<word_type>;
+
+public:
+
+    // +++++++++++++++++++ MEMBER TYPES +++++++++++++++++++
+
+    using value_type = bool;
+
+    using allocator_type = Alloc;
+
+    using size_type = std::size_t;
+
+    using difference_type = std::ptrdiff_t;
+
+    using reference = bit_reference;
+
+    using const_reference = bool;
+
+    using iterator = base_iterator<false>;
+
+    using const_iterator = base_iterator<true>;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    //  ITERATORS
+
+    [[nodiscard]] constexpr iterator begin() { return iterator(words_.data(), 0); }
+
+    [[nodiscard]] constexpr iterator end() { return iterator(words_.data(), sz_); }
+
+    [[nodiscard]] constexpr const_iterator begin() const { return const_iterator(words_.data(), 0); }
+
+    [[nodiscard]] constexpr const_iterator end() const { return const_iterator(words_.data(), sz_); }
+
+    [[nodiscard]] constexpr const_iterator cbegin() const { return begin(); }
+
+    [[nodiscard]] constexpr const_iterator cend() const { return end(); }
+
+    [[nodiscard]] constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+    [[nodiscard]] constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
+
+    [[nodiscard]] constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    [[nodiscard]] constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    [[nodiscard]] constexpr const_reverse_iterator crbegin() const { return rbegin(); }
+
+    [[nodiscard]] constexpr const_reverse_iterator crend() const { return rend(); }
+
+    // +++++++++++++++++++ CONSTRUCTORS, DTOR +++++++++++++++++++
+
+    // Default constructor. Constructs an empty container
+    VECTOR_SITE_EXPLICIT constexpr vector(VECTOR_SITE_PARAM) : words_(VECTOR_SITE_ARG), sz_(0) {}
+
+    // Constructs the container with 'sz' false bits
+    constexpr explicit vector(size_type sz VECTOR_SITE_PARAM_NEXT);
+
+    // Constructs the container with the contents of the initializer list
+    constexpr vector(std::initializer_list<bool> ilist VECTOR_SITE_PARAM_NEXT);
+
+    // Constructs the container with 'sz' bits equal to 'value'
+    constexpr explicit vector(size_type sz, bool value VECTOR_SITE_PARAM_NEXT);
+
+    // Constructs the container with the contents of the range [first, last]
+    template <typename InputIt> requires (!std::is_integral_v<InputIt>)
+    constexpr vector(InputIt first, InputIt last VECTOR_SITE_PARAM_NEXT);
+
+    // Copy constructor
+    constexpr vector(const vector& other VECTOR_SITE_PARAM_NEXT) : words_(other.words_ VECTOR_SITE_ARG_NEXT), sz_(other.sz_) {}
+
+    // Move constructor. Leaves 'other' empty
+    constexpr vector(vector&& other VECTOR_SITE_PARAM_NEXT) noexcept
+        : words_(std::move(other.words_) VECTOR_SITE_ARG_NEXT), sz_(other.sz_) { other.sz_ = 0; }
+
+    constexpr ~vector() noexcept = default;
+
+    // Copy assignment operator
+    constexpr vector& operator=(const vector& other);
+
+    // Move assignment operator
+    constexpr vector& operator=(vector&& other) noexcept;
+
+    // Returns the allocator associated with the container
+    constexpr allocator_type get_allocator() const noexcept { return allocator_type(words_.get_allocator()); }
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+    // Returns a proxy to the bit at 'index'. No bounds checking is performed.
+    constexpr reference operator[](size_type index) noexcept;
+
+    // Returns the bit at 'index'. No bounds checking is performed.
+    constexpr const_reference operator[](size_type index) const noexcept;
+
+    // Returns a proxy to the bit at 'index', with bounds checking.
+    constexpr reference at(size_type index);
+
+    // Returns the bit at 'index', with bounds checking.
+    constexpr const_reference at(size_type index) const;
+
+    constexpr reference front() { return (*this)[0]; }
+
+    constexpr const_reference front() const { return (*this)[0]; }
+
+    constexpr reference back() { return (*this)[sz_ - 1]; }
+
+    constexpr const_reference back() const { return (*this)[sz_ - 1]; }
+
+    // Returns the underlying words. Bit i is bit (i % 64) of word i / 64; bits past size() are zero
+    constexpr std::span<const word_type> words() const noexcept { return std::span<const word_type>(words_.data(), words_.size()); }
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+    // Checks if the container has no elements
+    constexpr bool empty() const noexcept { return sz_ == 0; }
+
+    // Returns the number of bits
+    constexpr size_type size() const noexcept { return sz_; }
+
+    // Returns the number of bits that can be held without reallocation
+    constexpr size_type capacity() const noexcept { return words_.capacity() * bits_per_word; }
+
+    // Reserves storage for at least 'newcap' bits
+    constexpr void reserve(size_type newcap);
+
+    // Frees the words that are not needed for size() bits
+    constexpr void shrink_to_fit() { words_.shrink_to_fit(); }
+
+    // Returns the maximum number of bits
+    constexpr size_type max_size() const noexcept {
+        return std::min(words_.max_size(), std::numeric_limits<size_type>::max() / bits_per_word) * bits_per_word;
+    }
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+    // Appends a bit
+    constexpr void push_back(bool value);
+
+    // Removes the last bit
+    constexpr void pop_back() noexcept;
+
+    // Clears the contents
+    constexpr void clear() noexcept { words_.clear(); sz_ = 0; }
+
+    // Swaps the contents
+    constexpr void swap(vector& other) noexcept { words_.swap(other.words_); std::swap(sz_, other.sz_); }
+
+    // Changes the number of bits. New bits are false
+    constexpr void resize(size_type count) { resize(count, false); }
+
+    // Changes the number of bits. New bits are equal to 'value'
+    constexpr void resize(size_type count, bool value);
+
+    // Replaces the contents with 'count' bits equal to 'value'
+    constexpr void assign(size_type count, bool value);
+
+    // Inserts 'value' before 'pos'
+    constexpr iterator insert(const_iterator pos, bool value) { return insert(pos, 1, value); }
+
+    // Inserts 'count' copies of 'value' before 'pos'
+    constexpr iterator insert(const_iterator pos, size_type count, bool value);
+
+    // Removes the bit at 'pos'
+    constexpr iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    // Removes the bits in the range [first, last]
+    constexpr iterator erase(const_iterator first, const_iterator last);
+
+    // +++++++++++++++++++ BIT OPERATIONS +++++++++++++++++++
+
+    // Sets every bit to true
+    constexpr void set() noexcept;
+
+    // Sets every bit to false
+    constexpr void reset() noexcept;
+
+    // Inverts every bit
+    constexpr void flip() noexcept;
+
+    // Returns the number of true bits
+    constexpr size_type count() const noexcept;
+
+    // Checks if every bit is true (true for an empty vector)
+    constexpr bool all() const noexcept { return count() == sz_; }
+
+    // Checks if any bit is true
+    constexpr bool any() const noexcept;
+
+    // Checks if no bit is true
+    constexpr bool none() const noexcept { return !any(); }
+
+    // Returns the index of the first true bit, size() if there is none
+    constexpr size_type find_first() const noexcept { return find_from(0); }
+
+    // Returns the index of the first true bit after 'pos', size() if there is none
+    constexpr size_type find_next(size_type pos) const noexcept { return pos >= sz_ ? sz_ : find_from(pos + 1); }
+
+    // Bitwise and with 'other'. Throws std::invalid_argument if the sizes differ
+    constexpr vector& operator&=(const vector& other);
+
+    // Bitwise or with 'other'. Throws std::invalid_argument if the sizes differ
+    constexpr vector& operator|=(const vector& other);
+
+    // Bitwise xor with 'other'. Throws std::invalid_argument if the sizes differ
+    constexpr vector& operator^=(const vector& other);
+
+    // Returns a copy with every bit inverted
+    constexpr vector operator~() const { vector copy(*this); copy.flip(); return copy; }
+
+#ifdef VECTOR_HEAP_PROFILE
+    // Attributes this vector to 'tag' instead of its construction site in heap profiles
+    void set_profile_tag(const char* tag) { words_.set_profile_tag(tag); }
+#endif
+
+private:
+    // number of words holding 'bits' bits
+    static constexpr size_type words_for(size_type bits) noexcept { return (bits + bits_per_word - 1) / bits_per_word; }
+
+    // clears the bits of the last word past sz_
+    constexpr void clear_tail() noexcept;
+
+    // sets the bits [first, last) to 'value' a word at a time
+    constexpr void fill_range(size_type first, size_type last, bool value) noexcept;
+
+    // returns the 'n' (1..64) bits starting at 'pos' in the low bits of a word
+    constexpr word_type read_bits(size_type pos, size_type n) const noexcept;
+
+    // overwrites the 'n' (1..64) bits starting at 'pos' with the low bits of 'value'
+    constexpr void write_bits(size_type pos, size_type n, word_type value) noexcept;
+
+    // copies the 'n' bits starting at 'from' to 'to'; the ranges may overlap
+    constexpr void move_bits(size_type from, size_type to, size_type n) noexcept;
+
+    // index of the first true bit at or after 'pos', sz_ if there is none
+    constexpr size_type find_from(size_type pos) const noexcept;
+
+    // throws std::invalid_argument unless 'other' has the same size
+    constexpr void check_same_size(const vector& other) const;
+
+private:
+    vector<word_type, word_allocator> words_;
+    size_type sz_;
+};
+
+// +++++++++++++++++++ CLASS vector<bool> IMPLEMENTATION +++++++++++++++++++
+
+    // +++++++++++++++++++ CONSTRUCTORS +++++++++++++++++++
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::vector(size_type sz VECTOR_SITE_DEF_NEXT)
+    : words_(words_for(sz), word_type(0) VECTOR_SITE_ARG_NEXT), sz_(sz) {}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::vector(std::initializer_list<bool> ilist VECTOR_SITE_DEF_NEXT)
+    : words_(words_for(ilist.size()), word_type(0) VECTOR_SITE_ARG_NEXT), sz_(ilist.size()) {
+    size_type index = 0;
+    for (bool value : ilist) {
+        words_[index / bits_per_word] |= word_type(value) << (index % bits_per_word);
+        ++index;
+    }
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::vector(size_type sz, bool value VECTOR_SITE_DEF_NEXT)
+    : words_(words_for(sz), value ? ~word_type(0) : word_type(0) VECTOR_SITE_ARG_NEXT), sz_(sz) {
+    clear_tail();
+}
+
+template<typename Alloc>
+template<typename InputIt> requires (!std::is_integral_v<InputIt>)
+constexpr vector<bool, Alloc>::vector(InputIt first, InputIt last VECTOR_SITE_DEF_NEXT) : words_(VECTOR_SITE_ARG), sz_(0) {
+    for (; first != last; ++first) {
+        push_back(static_cast<bool>(*first));
+    }
+}
+
+    // +++++++++++++++++++ ASSIGNMENT +++++++++++++++++++
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>& vector<bool, Alloc>::operator=(const vector& other) {
+    if (this != &other) {
+        words_ = other.words_;
+        sz_ = other.sz_;
+    }
+    return *this;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>& vector<bool, Alloc>::operator=(vector&& other) noexcept {
+    if (this != &other) {
+        words_ = std::move(other.words_);
+        sz_ = other.sz_;
+        other.sz_ = 0;
+    }
+    return *this;
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::assign(size_type count, bool value) {
+    clear();
+    resize(count, value);
+}
+
+    // +++++++++++++++++++ ELEMENT ACCESS +++++++++++++++++++
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::reference vector<bool, Alloc>::operator[](size_type index) noexcept {
+    return reference(words_.data() + index / bits_per_word, index % bits_per_word);
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::const_reference vector<bool, Alloc>::operator[](size_type index) const noexcept {
+    return ((words_[index / bits_per_word] >> (index % bits_per_word)) & 1) != 0;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::reference vector<bool, Alloc>::at(size_type index) {
+    if (index >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return (*this)[index];
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::const_reference vector<bool, Alloc>::at(size_type index) const {
+    if (index >= sz_) {
+        VECTOR_THROW(std::out_of_range("index out of range!"));
+    }
+    return (*this)[index];
+}
+
+    // +++++++++++++++++++ CAPACITY +++++++++++++++++++
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::reserve(size_type newcap) {
+    if (words_for(newcap) > words_.capacity()) {
+        words_.reserve(words_for(newcap));
+    }
+}
+
+    // +++++++++++++++++++ MODIFIERS +++++++++++++++++++
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::push_back(bool value) {
+    if (sz_ % bits_per_word == 0) {
+        words_.push_back(word_type(0));
+    }
+    words_[sz_ / bits_per_word] |= word_type(value) << (sz_ % bits_per_word);
+    ++sz_;
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::pop_back() noexcept {
+    if (sz_ > 0) {
+        --sz_;
+        if (sz_ % bits_per_word == 0) {
+            words_.pop_back();
+        }
+        else {
+            clear_tail();
+        }
+    }
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::resize(size_type count, bool value) {
+    if (count <= sz_) {
+        words_.resize(words_for(count));
+        sz_ = count;
+        clear_tail();
+        return;
+    }
+    size_type old_size = sz_;
+    words_.resize(words_for(count), word_type(0));
+    sz_ = count;
+    if (value) {
+        fill_range(old_size, count, true);
+    }
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::iterator vector<bool, Alloc>::insert(const_iterator pos, size_type count, bool value) {
+    if (pos < cbegin() || pos > cend()) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
+    }
+    size_type index = pos - cbegin();
+    size_type old_size = sz_;
+    resize(sz_ + count);
+    move_bits(index, index + count, old_size - index);
+    fill_range(index, index + count, value);
+    return begin() + index;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::iterator vector<bool, Alloc>::erase(const_iterator first, const_iterator last) {
+    if (first < cbegin() || last > cend() || first > last) {
+        VECTOR_THROW(std::out_of_range("Iterator out of range"));
+    }
+    size_type index = first - cbegin();
+    size_type count = last - first;
+    move_bits(index + count, index, sz_ - index - count);
+    resize(sz_ - count);
+    return begin() + index;
+}
+
+    // +++++++++++++++++++ BIT OPERATIONS +++++++++++++++++++
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::set() noexcept {
+    std::fill(words_.data(), words_.data() + words_.size(), ~word_type(0));
+    clear_tail();
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::reset() noexcept {
+    std::fill(words_.data(), words_.data() + words_.size(), word_type(0));
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::flip() noexcept {
+    word_type* words = words_.data();
+    const size_type n = words_.size();
+    for (size_type i = 0; i < n; ++i) {
+        words[i] = ~words[i];
+    }
+    clear_tail();
+}
+
+template<typename Alloc>
+constexpr std::size_t vector<bool, Alloc>::count() const noexcept {
+    const word_type* words = words_.data();
+    const size_type n = words_.size();
+    size_type total = 0;
+    for (size_type i = 0; i < n; ++i) {
+        total += static_cast<size_type>(std::popcount(words[i]));
+    }
+    return total;
+}
+
+template<typename Alloc>
+constexpr bool vector<bool, Alloc>::any() const noexcept {
+    const word_type* words = words_.data();
+    const size_type n = words_.size();
+    for (size_type i = 0; i < n; ++i) {
+        if (words[i] != 0) return true;
+    }
+    return false;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>& vector<bool, Alloc>::operator&=(const vector& other) {
+    check_same_size(other);
+    word_type* words = words_.data();
+    const word_type* other_words = other.words_.data();
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words[i] &= other_words[i];
+    }
+    return *this;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>& vector<bool, Alloc>::operator|=(const vector& other) {
+    check_same_size(other);
+    word_type* words = words_.data();
+    const word_type* other_words = other.words_.data();
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words[i] |= other_words[i];
+    }
+    return *this;
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>& vector<bool, Alloc>::operator^=(const vector& other) {
+    check_same_size(other);
+    word_type* words = words_.data();
+    const word_type* other_words = other.words_.data();
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words[i] ^= other_words[i];
+    }
+    return *this;
+}
+
+    // OTHER (private methods - helpers)
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::clear_tail() noexcept {
+    if (sz_ % bits_per_word != 0) {
+        words_[words_.size() - 1] &= (word_type(1) << (sz_ % bits_per_word)) - 1;
+    }
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::fill_range(size_type first, size_type last, bool value) noexcept {
+    while (first < last) {
+        size_type bit = first % bits_per_word;
+        size_type n = std::min(bits_per_word - bit, last - first);
+        word_type mask = (n == bits_per_word ? ~word_type(0) : (word_type(1) << n) - 1) << bit;
+        word_type& word = words_[first / bits_per_word];
+        word = value ? (word | mask) : (word & ~mask);
+        first += n;
+    }
+}
+
+template<typename Alloc>
+constexpr vector<bool, Alloc>::word_type vector<bool, Alloc>::read_bits(size_type pos, size_type n) const noexcept {
+    const size_type index = pos / bits_per_word;
+    const size_type bit = pos % bits_per_word;
+    word_type value = words_[index] >> bit;
+    if (bit + n > bits_per_word) {
+        value |= words_[index + 1] << (bits_per_word - bit);
+    }
+    return n == bits_per_word ? value : value & ((word_type(1) << n) - 1);
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::write_bits(size_type pos, size_type n, word_type value) noexcept {
+    const size_type index = pos / bits_per_word;
+    const size_type bit = pos % bits_per_word;
+    const word_type mask = n == bits_per_word ? ~word_type(0) : (word_type(1) << n) - 1;
+    words_[index] = (words_[index] & ~(mask << bit)) | (value << bit);
+    if (bit + n > bits_per_word) {
+        const word_type high_mask = mask >> (bits_per_word - bit);
+        words_[index + 1] = (words_[index + 1] & ~high_mask) | (value >> (bits_per_word - bit));
+    }
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::move_bits(size_type from, size_type to, size_type n) noexcept {
+    // chunks are cut at the word boundaries of the destination, so every write touches a single word;
+    // copying away from the overlap never overwrites a source bit that was not read yet
+    if (to < from) {
+        while (n > 0) {
+            const size_type chunk = std::min(n, bits_per_word - to % bits_per_word);
+            write_bits(to, chunk, read_bits(from, chunk));
+            from += chunk;
+            to += chunk;
+            n -= chunk;
+        }
+    }
+    else if (to > from) {
+        from += n;
+        to += n;
+        while (n > 0) {
+            const size_type chunk = std::min(n, to % bits_per_word == 0 ? bits_per_word : to % bits_per_word);
+            from -= chunk;
+            to -= chunk;
+            n -= chunk;
+            write_bits(to, chunk, read_bits(from, chunk));
+        }
+    }
+}
+
+template<typename Alloc>
+constexpr std::size_t vector<bool, Alloc>::find_from(size_type pos) const noexcept {
+    if (pos >= sz_) {
+        return sz_;
+    }
+    size_type index = pos / bits_per_word;
+    word_type word = words_[index] & (~word_type(0) << (pos % bits_per_word));
+    while (word == 0) {
+        if (++index == words_.size()) {
+            return sz_;
+        }
+        word = words_[index];
+    }
+    return index * bits_per_word + static_cast<size_type>(std::countr_zero(word));
+}
+
+template<typename Alloc>
+constexpr void vector<bool, Alloc>::check_same_size(const vector& other) const {
+    if (sz_ != other.sz_) {
+        VECTOR_THROW(std::invalid_argument("bit vectors differ in size"));
+    }
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator==(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.words().begin(), lhs.words().end(), rhs.words().begin());
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator!=(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+// sizes first, as for other vectors; then the first differing bit decides
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator<(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size();
+    }
+    auto lhs_words = lhs.words();
+    auto rhs_words = rhs.words();
+    for (std::size_t i = 0; i < lhs_words.size(); ++i) {
+        if (std::uint64_t diff = lhs_words[i] ^ rhs_words[i]; diff != 0) {
+            return (lhs_words[i] & (diff & (~diff + 1))) == 0;
+        }
+    }
+    return false;
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator>(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator<=(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr bool operator>=(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr vector<bool, Alloc> operator&(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    vector<bool, Alloc> result(lhs);
+    result &= rhs;
+    return result;
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr vector<bool, Alloc> operator|(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    vector<bool, Alloc> result(lhs);
+    result |= rhs;
+    return result;
+}
+
+template<typename Alloc>
+[[nodiscard]]
+constexpr vector<bool, Alloc> operator^(const vector<bool, Alloc>& lhs, const vector<bool, Alloc>& rhs) {
+    vector<bool, Alloc> result(lhs);
+    result ^= rhs;
+    return result;
+}
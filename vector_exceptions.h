@@ -0,0 +1,30 @@
+/*
+ * Error handling policy shared by the containers.
+ *
+ * With exceptions enabled (the default) errors are thrown as usual. Compiled with -fno-exceptions
+ * the rollback handlers become dead 'if (false)' blocks and every throw calls VECTOR_ABORT(what),
+ * which defaults to std::abort(). Define VECTOR_ABORT before including a container to log 'what'
+ * (the stringized exception) first. Code that must survive a failure uses the error-code
+ * functions (vector::try_push_back, try_reserve, try_insert), which work in both modes.
+ */
+
+#pragma once
+
+#include <cstdlib>
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define VECTOR_EXCEPTIONS 1
+#define VECTOR_TRY try
+#define VECTOR_CATCH(...) catch (__VA_ARGS__)
+#define VECTOR_THROW(...) throw __VA_ARGS__
+#define VECTOR_RETHROW throw
+#else
+#define VECTOR_EXCEPTIONS 0
+#ifndef VECTOR_ABORT
+#define VECTOR_ABORT(what) std::abort()
+#endif
+#define VECTOR_TRY if (true)
+#define VECTOR_CATCH(...) if (false)
+#define VECTOR_THROW(...) VECTOR_ABORT(#__VA_ARGS__)
+#define VECTOR_RETHROW ((void)0)
+#endif
@@ -0,0 +1,340 @@
+/*
+ * Expression templates for element-wise arithmetic on numeric vectors.
+ *
+ * a + b * c, -a, sqrt(a), abs/exp/log, scalar operands and the element-wise comparisons
+ * lt/le/gt/ge/eq/ne (which produce masks, combinable with &, | and !) build a lightweight
+ * expression tree instead of temporary vectors. The tree is evaluated in a single loop when it is
+ * converted to a vector or passed to eval_into:
+ *
+ *     vector<double> r = a + b * c;        // one pass, no temporaries
+ *     eval_into(r, where(gt(a, 0.0), a, -a)); // reuses r's buffer
+ *     vector<bool> mask = lt(a, b);        // bit-packed mask
+ *
+ * Expressions refer to their vectors, they do not own them: an expression must not outlive the
+ * vectors it was built from. The element-wise comparisons are named functions because the
+ * comparison operators of vector compare whole containers.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+namespace vector_expr {
+
+template <typename Derived>
+class node;
+
+template <typename E>
+concept expression = std::is_base_of_v<node<std::remove_cvref_t<E>>, std::remove_cvref_t<E>>;
+
+template <typename V>
+struct is_numeric_vector : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_numeric_vector<vector<T, Alloc>> : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>> {};
+
+template <typename V>
+concept numeric_vector = is_numeric_vector<std::remove_cvref_t<V>>::value;
+
+template <typename X>
+concept scalar_operand = std::is_arithmetic_v<std::remove_cvref_t<X>>;
+
+template <typename X>
+concept sized_operand = expression<X> || numeric_vector<X>;
+
+template <typename X>
+concept operand = sized_operand<X> || scalar_operand<X>;
+
+// at least one side must be a vector or an expression, so plain arithmetic is left alone
+template <typename L, typename R>
+concept binary_operands = operand<L> && operand<R> && (sized_operand<L> || sized_operand<R>);
+
+// size() of a scalar: it matches any length
+inline constexpr std::size_t broadcast = static_cast<std::size_t>(-1);
+
+constexpr std::size_t combine_sizes(std::size_t lhs, std::size_t rhs) {
+    if (lhs == broadcast) return rhs;
+    if (rhs == broadcast || lhs == rhs) return lhs;
+    VECTOR_THROW(std::invalid_argument("vector expression operands differ in size"));
+}
+
+// CLASS node. Base of every expression: iteration and conversion to vector
+
+template <typename Derived>
+class node {
+public:
+    class const_iterator {
+    public:
+        using value_type = std::remove_cvref_t<decltype(std::declval<const Derived&>()[0])>;
+        using reference = value_type;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+
+        constexpr const_iterator() = default;
+        constexpr const_iterator(const Derived* expr, std::size_t index) : expr_(expr), index_(index) {}
+
+        constexpr value_type operator*() const { return (*expr_)[index_]; }
+        constexpr value_type operator[](difference_type n) const { return (*expr_)[index_ + n]; }
+
+        constexpr const_iterator& operator++() { ++index_; return *this; }
+        constexpr const_iterator operator++(int) { const_iterator copy = *this; ++index_; return copy; }
+        constexpr const_iterator& operator--() { --index_; return *this; }
+        constexpr const_iterator operator--(int) { const_iterator copy = *this; --index_; return copy; }
+        constexpr const_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        constexpr const_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        constexpr const_iterator operator+(difference_type n) const { return const_iterator(expr_, index_ + n); }
+        constexpr const_iterator operator-(difference_type n) const { return const_iterator(expr_, index_ - n); }
+        constexpr difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        constexpr bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        constexpr bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+        constexpr bool operator<(const const_iterator& other) const { return index_ < other.index_; }
+
+    private:
+        const Derived* expr_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    constexpr const_iterator begin() const { return const_iterator(&self(), 0); }
+
+    constexpr const_iterator end() const { return const_iterator(&self(), self().size()); }
+
+    // Evaluates the expression into a new vector in a single pass
+    template <typename T, typename Alloc>
+    constexpr operator vector<T, Alloc>() const { return vector<T, Alloc>(begin(), end()); }
+
+private:
+    constexpr const Derived& self() const { return static_cast<const Derived&>(*this); }
+};
+
+// CLASS terminal. A vector operand, read through its data pointer
+
+template <typename T>
+class terminal {
+public:
+    constexpr terminal(const T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    constexpr std::size_t size() const noexcept { return size_; }
+
+    constexpr T operator[](std::size_t index) const noexcept { return data_[index]; }
+
+private:
+    const T* data_;
+    std::size_t size_;
+};
+
+// CLASS scalar. A scalar operand, repeated for every element
+
+template <typename T>
+class scalar {
+public:
+    constexpr explicit scalar(T value) noexcept : value_(value) {}
+
+    constexpr std::size_t size() const noexcept { return broadcast; }
+
+    constexpr T operator[](std::size_t) const noexcept { return value_; }
+
+private:
+    T value_;
+};
+
+template <typename X>
+constexpr auto as_operand(const X& x) {
+    if constexpr (expression<X>) {
+        return x;
+    }
+    else if constexpr (numeric_vector<X>) {
+        return terminal<typename X::value_type>(x.data(), x.size());
+    }
+    else {
+        return scalar<X>(x);
+    }
+}
+
+template <typename X>
+using operand_t = decltype(as_operand(std::declval<const X&>()));
+
+// CLASS unary
+
+template <typename Op, typename E>
+class unary : public node<unary<Op, E>> {
+public:
+    constexpr explicit unary(E operand) : operand_(operand) {}
+
+    constexpr std::size_t size() const noexcept { return operand_.size(); }
+
+    constexpr auto operator[](std::size_t index) const { return Op{}(operand_[index]); }
+
+private:
+    E operand_;
+};
+
+// CLASS binary
+
+template <typename Op, typename L, typename R>
+class binary : public node<binary<Op, L, R>> {
+public:
+    constexpr binary(L lhs, R rhs) : lhs_(lhs), rhs_(rhs), size_(combine_sizes(lhs.size(), rhs.size())) {}
+
+    constexpr std::size_t size() const noexcept { return size_; }
+
+    constexpr auto operator[](std::size_t index) const { return Op{}(lhs_[index], rhs_[index]); }
+
+private:
+    L lhs_;
+    R rhs_;
+    std::size_t size_;
+};
+
+// CLASS conditional. where(mask, a, b)
+
+template <typename M, typename L, typename R>
+class conditional : public node<conditional<M, L, R>> {
+public:
+    constexpr conditional(M mask, L lhs, R rhs)
+        : mask_(mask), lhs_(lhs), rhs_(rhs), size_(combine_sizes(mask.size(), combine_sizes(lhs.size(), rhs.size()))) {}
+
+    constexpr std::size_t size() const noexcept { return size_; }
+
+    constexpr auto operator[](std::size_t index) const {
+        using value_type = std::common_type_t<decltype(lhs_[index]), decltype(rhs_[index])>;
+        return mask_[index] ? static_cast<value_type>(lhs_[index]) : static_cast<value_type>(rhs_[index]);
+    }
+
+private:
+    M mask_;
+    L lhs_;
+    R rhs_;
+    std::size_t size_;
+};
+
+template <typename Op, typename L, typename R>
+constexpr auto make_binary(const L& lhs, const R& rhs) {
+    return binary<Op, operand_t<L>, operand_t<R>>(as_operand(lhs), as_operand(rhs));
+}
+
+template <typename Op, typename E>
+constexpr auto make_unary(const E& operand) {
+    return unary<Op, operand_t<E>>(as_operand(operand));
+}
+
+struct sqrt_op { template <typename X> auto operator()(X x) const { return std::sqrt(x); } };
+struct abs_op { template <typename X> constexpr auto operator()(X x) const { return x < X(0) ? X(-x) : x; } };
+struct exp_op { template <typename X> auto operator()(X x) const { return std::exp(x); } };
+struct log_op { template <typename X> auto operator()(X x) const { return std::log(x); } };
+
+} // namespace vector_expr
+
+// +++++++++++++++++++ ARITHMETIC +++++++++++++++++++
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto operator+(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::plus<>>(lhs, rhs); }
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto operator-(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::minus<>>(lhs, rhs); }
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto operator*(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::multiplies<>>(lhs, rhs); }
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto operator/(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::divides<>>(lhs, rhs); }
+
+template <typename E> requires vector_expr::sized_operand<E>
+constexpr auto operator-(const E& operand) { return vector_expr::make_unary<std::negate<>>(operand); }
+
+template <typename E> requires vector_expr::sized_operand<E>
+auto sqrt(const E& operand) { return vector_expr::make_unary<vector_expr::sqrt_op>(operand); }
+
+template <typename E> requires vector_expr::sized_operand<E>
+constexpr auto abs(const E& operand) { return vector_expr::make_unary<vector_expr::abs_op>(operand); }
+
+template <typename E> requires vector_expr::sized_operand<E>
+auto exp(const E& operand) { return vector_expr::make_unary<vector_expr::exp_op>(operand); }
+
+template <typename E> requires vector_expr::sized_operand<E>
+auto log(const E& operand) { return vector_expr::make_unary<vector_expr::log_op>(operand); }
+
+// +++++++++++++++++++ MASKS +++++++++++++++++++
+
+// element-wise lhs < rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto lt(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::less<>>(lhs, rhs); }
+
+// element-wise lhs <= rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto le(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::less_equal<>>(lhs, rhs); }
+
+// element-wise lhs > rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto gt(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::greater<>>(lhs, rhs); }
+
+// element-wise lhs >= rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto ge(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::greater_equal<>>(lhs, rhs); }
+
+// element-wise lhs == rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto eq(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::equal_to<>>(lhs, rhs); }
+
+// element-wise lhs != rhs
+template <typename L, typename R> requires vector_expr::binary_operands<L, R>
+constexpr auto ne(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::not_equal_to<>>(lhs, rhs); }
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R> && (vector_expr::expression<L> || vector_expr::expression<R>)
+constexpr auto operator&(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::bit_and<>>(lhs, rhs); }
+
+template <typename L, typename R> requires vector_expr::binary_operands<L, R> && (vector_expr::expression<L> || vector_expr::expression<R>)
+constexpr auto operator|(const L& lhs, const R& rhs) { return vector_expr::make_binary<std::bit_or<>>(lhs, rhs); }
+
+template <typename E> requires vector_expr::expression<E>
+constexpr auto operator!(const E& operand) { return vector_expr::make_unary<std::logical_not<>>(operand); }
+
+// element-wise mask ? lhs : rhs. Both sides are evaluated
+template <typename M, typename L, typename R>
+    requires vector_expr::sized_operand<M> && vector_expr::operand<L> && vector_expr::operand<R>
+constexpr auto where(const M& mask, const L& lhs, const R& rhs) {
+    using namespace vector_expr;
+    return conditional<operand_t<M>, operand_t<L>, operand_t<R>>(as_operand(mask), as_operand(lhs), as_operand(rhs));
+}
+
+// +++++++++++++++++++ EVALUATION +++++++++++++++++++
+
+// Evaluates 'expr' into a new vector of its element type
+template <typename E> requires vector_expr::expression<E>
+constexpr auto eval(const E& expr) {
+    using value_type = typename E::const_iterator::value_type;
+    return vector<value_type>(expr.begin(), expr.end());
+}
+
+/* Evaluates 'expr' into 'out', resizing it to the expression's size and reusing its buffer.
+* 'out' may appear in the expression: element i is written only after it has been read */
+template <typename T, typename Alloc, typename E> requires vector_expr::expression<E>
+constexpr void eval_into(vector<T, Alloc>& out, const E& expr) {
+    const std::size_t n = expr.size();
+    if (out.size() != n) {
+        out.resize(n);
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<bool>(expr[i]);
+        }
+    }
+    else {
+        T* dst = out.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = static_cast<T>(expr[i]);
+        }
+    }
+}
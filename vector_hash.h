@@ -0,0 +1,250 @@
+/*
+ * Content hashing of vectors.
+ *
+ * fingerprint(v) hashes the raw bytes of a vector whose elements are trivially hashable (unique object
+ * representation: integers, enums, pointers, structs without padding) with four interleaved CRC32C lanes
+ * and a 64-bit finalizer. It uses the CRC32C instruction under __SSE4_2__ / __ARM_FEATURE_CRC32 and an
+ * equivalent table-driven loop otherwise, so the value only depends on the contents (on a little-endian
+ * machine), not on the build. It is fast, not collision resistant against adversarial input.
+ *
+ * hash(v) works for any element type with std::hash (floating point goes through std::hash, so 0.0 and
+ * -0.0 hash equal) and backs std::hash<vector<T, Alloc>>. vector_hasher<T> computes the same values
+ * incrementally, one element or span at a time, e.g. next to each push_back.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#include "vector.h"
+
+// Elements whose bytes can be hashed directly: equal values have equal object representations
+template <typename T>
+inline constexpr bool is_trivially_hashable_v = std::has_unique_object_representations_v<T>;
+
+namespace vector_hash_detail {
+
+// reflected CRC32C (Castagnoli) polynomial
+inline constexpr std::uint32_t crc32c_poly = 0x82F63B78u;
+
+// slicing-by-8 tables: tables[k][b] is the CRC of byte 'b' followed by k zero bytes
+inline constexpr std::array<std::array<std::uint32_t, 256>, 8> crc32c_tables = [] {
+    std::array<std::array<std::uint32_t, 256>, 8> tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (crc & 1 ? crc32c_poly : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < 8; ++k) {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}();
+
+inline std::uint32_t crc32c_u8(std::uint32_t crc, unsigned char byte) noexcept {
+#if defined(__SSE4_2__)
+    return _mm_crc32_u8(crc, byte);
+#elif defined(__ARM_FEATURE_CRC32)
+    return __crc32cb(crc, byte);
+#else
+    return crc32c_tables[0][(crc ^ byte) & 0xFF] ^ (crc >> 8);
+#endif
+}
+
+inline std::uint32_t crc32c_u64(std::uint32_t crc, std::uint64_t word) noexcept {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    return static_cast<std::uint32_t>(_mm_crc32_u64(crc, word));
+#elif defined(__ARM_FEATURE_CRC32)
+    return __crc32cd(crc, word);
+#else
+    const auto& t = crc32c_tables;
+    const std::uint32_t low = crc ^ static_cast<std::uint32_t>(word);
+    const std::uint32_t high = static_cast<std::uint32_t>(word >> 32);
+    return t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+        ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+#endif
+}
+
+// little-endian 8-byte load from any address
+inline std::uint64_t load64(const unsigned char* p) noexcept {
+    std::uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+        std::uint64_t swapped = 0;
+        for (int i = 0; i < 8; ++i, word >>= 8) {
+            swapped = (swapped << 8) | (word & 0xFF);
+        }
+        word = swapped;
+    }
+    return word;
+}
+
+// murmur3 64-bit finalizer: every input bit affects every output bit
+constexpr std::uint64_t fmix64(std::uint64_t x) noexcept {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+inline constexpr std::uint64_t golden = 0x9E3779B97F4A7C15ull;
+
+} // namespace vector_hash_detail
+
+// Incremental content hash: feeding the elements of 'v' in order gives hash(v) (and fingerprint(v))
+template <typename T>
+class vector_hasher {
+    static constexpr bool raw = is_trivially_hashable_v<T>;
+
+public:
+    // Feeds one element
+    void update(const T& value) noexcept(raw) { update(std::span<const T>(&value, 1)); }
+
+    // Feeds the elements of 'values' in order
+    void update(std::span<const T> values) noexcept(raw);
+
+    // Returns the hash of everything fed so far; more elements can still be added afterwards
+    [[nodiscard]] std::uint64_t digest() const noexcept;
+
+    // Starts over, as if nothing had been fed
+    void reset() noexcept { *this = vector_hasher(); }
+
+private:
+    // feeds raw bytes: whole words go round-robin to the four CRC lanes, the rest waits in 'pending_'
+    void update_bytes(const unsigned char* p, std::size_t n) noexcept;
+
+private:
+    // byte hashing state
+    std::uint32_t lanes_[4] = { 0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u };
+    std::size_t words_ = 0;
+    unsigned char pending_[8] = {};
+    std::size_t pending_size_ = 0;
+
+    // element hashing state (types without a unique object representation)
+    std::uint64_t state_ = vector_hash_detail::golden;
+
+    // bytes (raw) or elements fed so far
+    std::uint64_t length_ = 0;
+};
+
+// +++++++++++++++++++ CLASS vector_hasher IMPLEMENTATION +++++++++++++++++++
+
+template<typename T>
+void vector_hasher<T>::update(std::span<const T> values) noexcept(raw) {
+    if constexpr (raw) {
+        update_bytes(reinterpret_cast<const unsigned char*>(values.data()), values.size_bytes());
+    }
+    else {
+        for (const T& value : values) {
+            state_ = vector_hash_detail::fmix64(state_ ^ (std::hash<T>()(value) + vector_hash_detail::golden));
+        }
+        length_ += values.size();
+    }
+}
+
+template<typename T>
+void vector_hasher<T>::update_bytes(const unsigned char* p, std::size_t n) noexcept {
+    using namespace vector_hash_detail;
+    if (n == 0) {
+        return;
+    }
+    length_ += n;
+    if (pending_size_ > 0) {
+        const std::size_t take = std::min(n, sizeof(pending_) - pending_size_);
+        std::memcpy(pending_ + pending_size_, p, take);
+        pending_size_ += take;
+        p += take;
+        n -= take;
+        if (pending_size_ < sizeof(pending_)) {
+            return;
+        }
+        lanes_[words_ & 3] = crc32c_u64(lanes_[words_ & 3], load64(pending_));
+        ++words_;
+        pending_size_ = 0;
+    }
+    // single words up to the next lane 0, then whole 32-byte blocks with the four chains independent
+    for (; n >= 8 && (words_ & 3) != 0; p += 8, n -= 8) {
+        lanes_[words_ & 3] = crc32c_u64(lanes_[words_ & 3], load64(p));
+        ++words_;
+    }
+    std::uint32_t a = lanes_[0], b = lanes_[1], c = lanes_[2], d = lanes_[3];
+    for (; n >= 32; p += 32, n -= 32) {
+        a = crc32c_u64(a, load64(p));
+        b = crc32c_u64(b, load64(p + 8));
+        c = crc32c_u64(c, load64(p + 16));
+        d = crc32c_u64(d, load64(p + 24));
+        words_ += 4;
+    }
+    lanes_[0] = a; lanes_[1] = b; lanes_[2] = c; lanes_[3] = d;
+    for (; n >= 8; p += 8, n -= 8) {
+        lanes_[words_ & 3] = crc32c_u64(lanes_[words_ & 3], load64(p));
+        ++words_;
+    }
+    std::memcpy(pending_, p, n);
+    pending_size_ = n;
+}
+
+template<typename T>
+std::uint64_t vector_hasher<T>::digest() const noexcept {
+    using namespace vector_hash_detail;
+    if constexpr (raw) {
+        std::uint32_t lanes[4] = { lanes_[0], lanes_[1], lanes_[2], lanes_[3] };
+        // the trailing bytes go into the lane whose turn it is
+        for (std::size_t i = 0; i < pending_size_; ++i) {
+            lanes[words_ & 3] = crc32c_u8(lanes[words_ & 3], pending_[i]);
+        }
+        const std::uint64_t low = (std::uint64_t(lanes[0]) << 32) | lanes[1];
+        const std::uint64_t high = (std::uint64_t(lanes[2]) << 32) | lanes[3];
+        return fmix64(low ^ fmix64(high ^ (length_ * golden)));
+    }
+    else {
+        return fmix64(state_ ^ (length_ * golden));
+    }
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+// Build-independent 64-bit fingerprint of the contents (see the top of the file)
+template<typename T, typename Alloc> requires is_trivially_hashable_v<T>
+[[nodiscard]]
+std::uint64_t fingerprint(const vector<T, Alloc>& v) noexcept {
+    vector_hasher<T> hasher;
+    hasher.update(std::span<const T>(v.data(), v.size()));
+    return hasher.digest();
+}
+
+// Hash of the contents: the fingerprint for trivially hashable T, a combination of std::hash<T> otherwise
+template<typename T, typename Alloc>
+    requires (is_trivially_hashable_v<T> || requires (const T& value) { std::hash<T>()(value); })
+[[nodiscard]]
+std::size_t hash(const vector<T, Alloc>& v) {
+    vector_hasher<T> hasher;
+    hasher.update(std::span<const T>(v.data(), v.size()));
+    return static_cast<std::size_t>(hasher.digest());
+}
+
+template<typename T, typename Alloc>
+    requires (is_trivially_hashable_v<T> || requires (const T& value) { std::hash<T>()(value); })
+struct std::hash<::vector<T, Alloc>> {
+    // inside namespace std, plain 'vector' would name std::vector
+    std::size_t operator()(const ::vector<T, Alloc>& v) const { return ::hash(v); }
+};
@@ -0,0 +1,250 @@
+/*
+ * vector_intern_pool<T> - stores each distinct vector contents once.
+ *
+ * intern() looks the contents up by hash and equality and returns an interned_vector handle to the
+ * single shared copy, so equal contents from the same pool compare equal by pointer in O(1).
+ * Handles are reference counted: copying and destroying one is a lock-free atomic operation, only
+ * the release of the last handle takes the pool lock to drop the entry. The pool must outlive all
+ * of its handles. intern() may be called concurrently from any number of threads.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+#include "vector.h"
+#include "vector_hash.h"
+
+template <typename T, typename Alloc>
+class vector_intern_pool;
+
+// CLASS interned_vector. Shared, immutable contents owned by a vector_intern_pool
+
+template <typename T, typename Alloc = std::allocator<T>>
+class interned_vector {
+    friend class vector_intern_pool<T, Alloc>;
+
+    struct entry {
+        const vector<T, Alloc> values;
+        const std::size_t hash;
+        std::atomic<std::size_t> refs{ 1 };
+        vector_intern_pool<T, Alloc>* pool;
+    };
+
+public:
+    using value_type = T;
+
+    using size_type = std::size_t;
+
+    using const_iterator = const T*;
+
+    // Creates a handle to nothing, equal only to other empty handles
+    constexpr interned_vector() noexcept = default;
+
+    interned_vector(const interned_vector& other) noexcept : entry_(other.entry_) {
+        if (entry_ != nullptr) {
+            entry_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    interned_vector(interned_vector&& other) noexcept : entry_(std::exchange(other.entry_, nullptr)) {}
+
+    interned_vector& operator=(interned_vector other) noexcept { std::swap(entry_, other.entry_); return *this; }
+
+    ~interned_vector() { release(); }
+
+    // Checks if the handle refers to interned contents
+    explicit operator bool() const noexcept { return entry_ != nullptr; }
+
+    // Returns the shared contents. The handle must not be empty
+    const vector<T, Alloc>& operator*() const noexcept { return entry_->values; }
+
+    // Returns the shared contents. The handle must not be empty
+    const vector<T, Alloc>* operator->() const noexcept { return &entry_->values; }
+
+    // Returns the contents as a span, empty for an empty handle
+    std::span<const T> values() const noexcept {
+        return entry_ != nullptr ? std::span<const T>(entry_->values.data(), entry_->values.size()) : std::span<const T>();
+    }
+
+    const_iterator begin() const noexcept { return values().data(); }
+
+    const_iterator end() const noexcept { return values().data() + values().size(); }
+
+    size_type size() const noexcept { return values().size(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    // Returns the content hash computed when the contents were interned (0 for an empty handle)
+    std::size_t hash() const noexcept { return entry_ != nullptr ? entry_->hash : 0; }
+
+    // O(1): handles of the same pool are equal exactly when their contents are
+    friend bool operator==(const interned_vector& lhs, const interned_vector& rhs) noexcept { return lhs.entry_ == rhs.entry_; }
+
+    friend bool operator!=(const interned_vector& lhs, const interned_vector& rhs) noexcept { return lhs.entry_ != rhs.entry_; }
+
+private:
+    explicit interned_vector(entry* e) noexcept : entry_(e) {}
+
+    // drops this reference; the thread that releases the last one removes the entry from the pool
+    void release() noexcept;
+
+private:
+    entry* entry_ = nullptr;
+};
+
+// CLASS vector_intern_pool
+
+template <typename T, typename Alloc = std::allocator<T>>
+class vector_intern_pool {
+    friend class interned_vector<T, Alloc>;
+    using entry = typename interned_vector<T, Alloc>::entry;
+
+public:
+    using handle = interned_vector<T, Alloc>;
+
+    using size_type = std::size_t;
+
+    vector_intern_pool() = default;
+
+    vector_intern_pool(const vector_intern_pool&) = delete;
+    vector_intern_pool& operator=(const vector_intern_pool&) = delete;
+
+    // All handles must have been released by now
+    ~vector_intern_pool();
+
+    // Returns the handle for 'values', adding a copy of them to the pool if they are new
+    [[nodiscard]] handle intern(std::span<const T> values);
+
+    // Returns the handle for the contents of 'v'
+    [[nodiscard]] handle intern(const vector<T, Alloc>& v) { return intern(std::span<const T>(v.data(), v.size())); }
+
+    // Returns the handle for the contents of 'v', taking over its buffer if they are new
+    [[nodiscard]] handle intern(vector<T, Alloc>&& v);
+
+    // Returns the number of distinct contents currently interned
+    size_type size() const;
+
+private:
+    // finds live contents equal to 'values' and takes a reference to them; nullptr if there are none
+    entry* acquire(std::span<const T> values, std::size_t hash);
+
+    // removes an entry whose last handle is gone
+    void erase(entry* e) noexcept;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_multimap<std::size_t, entry*> entries_;
+};
+
+// +++++++++++++++++++ CLASS interned_vector IMPLEMENTATION +++++++++++++++++++
+
+template<typename T, typename Alloc>
+void interned_vector<T, Alloc>::release() noexcept {
+    // acq_rel: the last owner must see every other owner's reads of the contents finished
+    if (entry_ != nullptr && entry_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        entry_->pool->erase(entry_);
+    }
+    entry_ = nullptr;
+}
+
+// +++++++++++++++++++ CLASS vector_intern_pool IMPLEMENTATION +++++++++++++++++++
+
+template<typename T, typename Alloc>
+vector_intern_pool<T, Alloc>::~vector_intern_pool() {
+    for (auto& [hash, e] : entries_) {
+        delete e;
+    }
+}
+
+template<typename T, typename Alloc>
+interned_vector<T, Alloc> vector_intern_pool<T, Alloc>::intern(std::span<const T> values) {
+    vector_hasher<T> hasher;
+    hasher.update(values);
+    const std::size_t hash = static_cast<std::size_t>(hasher.digest());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entry* e = acquire(values, hash)) {
+        return handle(e);
+    }
+    entry* e = new entry{ vector<T, Alloc>(values.begin(), values.end()), hash, 1, this };
+    VECTOR_TRY {
+        entries_.emplace(hash, e);
+    }
+    VECTOR_CATCH(...) {
+        delete e;
+        VECTOR_RETHROW;
+    }
+    return handle(e);
+}
+
+template<typename T, typename Alloc>
+interned_vector<T, Alloc> vector_intern_pool<T, Alloc>::intern(vector<T, Alloc>&& v) {
+    const std::size_t hash = ::hash(v);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entry* e = acquire(std::span<const T>(v.data(), v.size()), hash)) {
+        return handle(e);
+    }
+    entry* e = new entry{ std::move(v), hash, 1, this };
+    VECTOR_TRY {
+        entries_.emplace(hash, e);
+    }
+    VECTOR_CATCH(...) {
+        delete e;
+        VECTOR_RETHROW;
+    }
+    return handle(e);
+}
+
+template<typename T, typename Alloc>
+vector_intern_pool<T, Alloc>::size_type vector_intern_pool<T, Alloc>::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+template<typename T, typename Alloc>
+vector_intern_pool<T, Alloc>::entry* vector_intern_pool<T, Alloc>::acquire(std::span<const T> values, std::size_t hash) {
+    auto [first, last] = entries_.equal_range(hash);
+    for (; first != last; ++first) {
+        entry* e = first->second;
+        if (!std::equal(e->values.data(), e->values.data() + e->values.size(), values.begin(), values.end())) {
+            continue;
+        }
+        // an entry whose count already reached zero is being erased and must not come back to life
+        std::size_t refs = e->refs.load(std::memory_order_relaxed);
+        while (refs != 0 && !e->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_relaxed)) {}
+        if (refs != 0) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+template<typename T, typename Alloc>
+void vector_intern_pool<T, Alloc>::erase(entry* e) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [first, last] = entries_.equal_range(e->hash);
+        for (; first != last; ++first) {
+            if (first->second == e) {
+                entries_.erase(first);
+                break;
+            }
+        }
+    }
+    delete e;
+}
+
+    // +++++++++++++++++++ NON-MEMBER FUNCTIONS +++++++++++++++++++
+
+template<typename T, typename Alloc>
+struct std::hash<interned_vector<T, Alloc>> {
+    std::size_t operator()(const interned_vector<T, Alloc>& v) const noexcept { return v.hash(); }
+};
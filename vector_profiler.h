@@ -0,0 +1,216 @@
+/*
+ * Per-call-site heap profiler for vector.
+ *
+ * Enabled by defining VECTOR_HEAP_PROFILE before including vector.h. Every vector then
+ * remembers the std::source_location of its construction (or a tag set with
+ * vector::set_profile_tag), and the profiler aggregates live bytes, slack bytes
+ * (capacity - size) and reallocation counts per site. Without the macro this header
+ * is not included and vector carries no profiling state.
+ *
+ * Reports can be taken from any thread. A vector reports its capacity under the profiler
+ * lock whenever its buffer changes hands (reallocation, move, swap) and publishes its size
+ * in a relaxed atomic of its own on every push, insert, erase, resize and clear; snapshot()
+ * reads those atomics under the lock, so a report never races with the vectors it describes.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// CLASS vector_heap_profiler
+class vector_heap_profiler {
+public:
+    // Aggregated statistics of one call site
+    struct site_report {
+        std::string site;
+        std::string function;
+        std::string element_type;
+        std::size_t instances = 0;         // vectors alive right now
+        std::size_t constructions = 0;     // vectors ever created at the site
+        std::size_t live_bytes = 0;        // sum of size() * sizeof(T)
+        std::size_t slack_bytes = 0;       // sum of (capacity() - size()) * sizeof(T)
+        std::size_t reallocations = 0;     // buffer replacements since the first construction
+    };
+
+    // Returns the process-wide profiler. Never destroyed, so vectors with static storage duration may outlive main
+    static vector_heap_profiler& instance() {
+        static vector_heap_profiler* profiler = new vector_heap_profiler();
+        return *profiler;
+    }
+
+    /* Registers a new vector 'instance' created at 'loc' with a buffer of 'capacity_bytes'. 'live_bytes' is
+    * the instance's own size counter, read by snapshot() until the instance is unregistered */
+    void register_instance(const void* instance, const std::source_location& loc, const char* element_type,
+        const std::atomic<std::size_t>* live_bytes, std::size_t capacity_bytes) {
+        std::string key = std::string(loc.file_name()) + ":" + std::to_string(loc.line()) + ":" + std::to_string(loc.column());
+        register_instance(instance, std::move(key), loc.function_name(), element_type, live_bytes, capacity_bytes);
+    }
+
+    // Registers a new vector 'instance' under a caller-supplied 'tag'
+    void register_instance(const void* instance, const char* tag, const char* element_type,
+        const std::atomic<std::size_t>* live_bytes, std::size_t capacity_bytes) {
+        register_instance(instance, std::string(tag), "", element_type, live_bytes, capacity_bytes);
+    }
+
+    // Removes a destroyed vector 'instance'
+    void unregister_instance(const void* instance) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        instances_.erase(instance);
+    }
+
+    // Counts a buffer reallocation of 'instance' and records its new capacity
+    void record_reallocation(const void* instance, std::size_t capacity_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = instances_.find(instance);
+        if (it != instances_.end()) {
+            ++it->second.site->reallocations;
+            it->second.capacity_bytes = capacity_bytes;
+        }
+    }
+
+    // Records the capacity of 'instance' after its buffer moved to or from another vector
+    void record_capacity(const void* instance, std::size_t capacity_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = instances_.find(instance);
+        if (it != instances_.end()) {
+            it->second.capacity_bytes = capacity_bytes;
+        }
+    }
+
+    // Returns per-site statistics sorted by slack bytes, largest first
+    std::vector<site_report> snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_map<const site_data*, site_report> reports;
+        for (const auto& [key, site] : sites_) {
+            site_report& report = reports[&site];
+            report.site = key;
+            report.function = site.function;
+            report.element_type = site.element_type;
+            report.constructions = site.constructions;
+            report.reallocations = site.reallocations;
+        }
+        for (const auto& [instance, entry] : instances_) {
+            site_report& report = reports[entry.site];
+            // the size may already be ahead of a capacity change the vector has not recorded yet
+            const std::size_t live = std::min(entry.live_bytes->load(std::memory_order_relaxed), entry.capacity_bytes);
+            ++report.instances;
+            report.live_bytes += live;
+            report.slack_bytes += entry.capacity_bytes - live;
+        }
+
+        std::vector<site_report> result;
+        result.reserve(reports.size());
+        for (auto& [site, report] : reports) {
+            result.push_back(std::move(report));
+        }
+        std::sort(result.begin(), result.end(), [](const site_report& lhs, const site_report& rhs) {
+            if (lhs.slack_bytes != rhs.slack_bytes) return lhs.slack_bytes > rhs.slack_bytes;
+            return lhs.live_bytes > rhs.live_bytes;
+        });
+        return result;
+    }
+
+    // Writes a human readable table of all sites
+    void report_text(std::ostream& out) const {
+        std::size_t total_live = 0, total_slack = 0;
+        out << "vector heap profile (sorted by slack bytes)\n";
+        for (const site_report& report : snapshot()) {
+            total_live += report.live_bytes;
+            total_slack += report.slack_bytes;
+            out << report.site << " [" << report.element_type << "]"
+                << (report.function.empty() ? "" : " in ") << report.function << "\n"
+                << "    instances " << report.instances << " (constructed " << report.constructions << ")"
+                << ", live " << report.live_bytes << " B"
+                << ", slack " << report.slack_bytes << " B"
+                << ", reallocations " << report.reallocations << "\n";
+        }
+        out << "total: live " << total_live << " B, slack " << total_slack << " B\n";
+    }
+
+    // Writes all sites as a JSON array
+    void report_json(std::ostream& out) const {
+        out << "[";
+        bool first = true;
+        for (const site_report& report : snapshot()) {
+            out << (first ? "\n" : ",\n") << "  {\"site\": ";
+            write_json_string(out, report.site);
+            out << ", \"function\": ";
+            write_json_string(out, report.function);
+            out << ", \"element_type\": ";
+            write_json_string(out, report.element_type);
+            out << ", \"instances\": " << report.instances
+                << ", \"constructions\": " << report.constructions
+                << ", \"live_bytes\": " << report.live_bytes
+                << ", \"slack_bytes\": " << report.slack_bytes
+                << ", \"reallocations\": " << report.reallocations << "}";
+            first = false;
+        }
+        out << (first ? "]\n" : "\n]\n");
+    }
+
+    // Forgets all sites that have no live instances
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = sites_.begin(); it != sites_.end();) {
+            bool used = std::any_of(instances_.begin(), instances_.end(),
+                [&](const auto& entry) { return entry.second.site == &it->second; });
+            it = used ? std::next(it) : sites_.erase(it);
+        }
+    }
+
+private:
+    struct site_data {
+        std::string function;
+        std::string element_type;
+        std::size_t constructions = 0;
+        std::size_t reallocations = 0;
+    };
+
+    struct instance_entry {
+        site_data* site;
+        const std::atomic<std::size_t>* live_bytes;
+        std::size_t capacity_bytes;
+    };
+
+    vector_heap_profiler() = default;
+
+    void register_instance(const void* instance, std::string key, const char* function, const char* element_type,
+        const std::atomic<std::size_t>* live_bytes, std::size_t capacity_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        site_data& site = sites_[std::move(key)];
+        if (site.constructions == 0) {
+            site.function = function;
+            site.element_type = element_type;
+        }
+        ++site.constructions;
+        instances_[instance] = instance_entry{ &site, live_bytes, capacity_bytes };
+    }
+
+    static void write_json_string(std::ostream& out, const std::string& value) {
+        out << '"';
+        for (char c : value) {
+            switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:   out << c; break;
+            }
+        }
+        out << '"';
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, site_data> sites_;    // node-based: site pointers stay valid
+    std::unordered_map<const void*, instance_entry> instances_;
+};